@@ -69,8 +69,17 @@ class Camera
         aspect     = static_cast<float>(width) / static_cast<float>(height);
         viewport.x = static_cast<float>(width);
         viewport.y = static_cast<float>(height);
-        viewport.z = CAM_NEAR;
-        viewport.w = CAM_FAR;
+        viewport.z = near;
+        viewport.w = far;
+    }
+
+    void SetClipPlanes(float nearPlane, float farPlane)
+    {
+        near       = nearPlane;
+        far        = farPlane;
+        viewport.z = near;
+        viewport.w = far;
+        UpdateMatrices();
     }
 
     virtual void HandleInput(WindowInput) {};
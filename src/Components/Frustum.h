@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <xmmintrin.h>
+
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace drive
+{
+// View frustum planes, normals point inwards.
+// Planes are stored 4 at a time for testing boxes against all of them at once.
+class Frustum
+{
+  public:
+    // Planes of a projection * view matrix, depth range [0, 1].
+    Frustum(const glm::mat4& viewProj)
+    {
+        const glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+        const glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+        const glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+        const glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+        const glm::vec4 planes[m_planeCount] = {
+            row3 + row0, // Left
+            row3 - row0, // Right
+            row3 + row1, // Bottom
+            row3 - row1, // Top
+            row2,        // Near
+            row3 - row2, // Far
+        };
+
+        // Padding planes accept everything.
+        alignas(16) float x[m_laneCount] = {};
+        alignas(16) float y[m_laneCount] = {};
+        alignas(16) float z[m_laneCount] = {};
+        alignas(16) float w[m_laneCount] = {};
+        for (int i = 0; i < m_laneCount; i++)
+        {
+            w[i] = 1.0f;
+        }
+
+        for (int i = 0; i < m_planeCount; i++)
+        {
+            const auto normal = glm::vec3(planes[i].x, planes[i].y, planes[i].z);
+            const auto plane  = planes[i] / glm::length(normal);
+            m_planes[i]       = plane;
+            x[i]              = plane.x;
+            y[i]              = plane.y;
+            z[i]              = plane.z;
+            w[i]              = plane.w;
+        }
+
+        for (int i = 0; i < m_groupCount; i++)
+        {
+            m_x[i] = _mm_load_ps(x + 4 * i);
+            m_y[i] = _mm_load_ps(y + 4 * i);
+            m_z[i] = _mm_load_ps(z + 4 * i);
+            m_w[i] = _mm_load_ps(w + 4 * i);
+        }
+    }
+
+    // False if the box is fully outside any plane.
+    bool IsBoxVisible(glm::vec3 min, glm::vec3 max) const
+    {
+        const __m128 minX = _mm_set1_ps(min.x);
+        const __m128 minY = _mm_set1_ps(min.y);
+        const __m128 minZ = _mm_set1_ps(min.z);
+        const __m128 maxX = _mm_set1_ps(max.x);
+        const __m128 maxY = _mm_set1_ps(max.y);
+        const __m128 maxZ = _mm_set1_ps(max.z);
+
+        int outside = 0;
+        for (int i = 0; i < m_groupCount; i++)
+        {
+            // Distance of the corner furthest along each plane normal.
+            __m128 distance = m_w[i];
+            distance = _mm_add_ps(
+                distance,
+                _mm_max_ps(_mm_mul_ps(m_x[i], minX), _mm_mul_ps(m_x[i], maxX))
+            );
+            distance = _mm_add_ps(
+                distance,
+                _mm_max_ps(_mm_mul_ps(m_y[i], minY), _mm_mul_ps(m_y[i], maxY))
+            );
+            distance = _mm_add_ps(
+                distance,
+                _mm_max_ps(_mm_mul_ps(m_z[i], minZ), _mm_mul_ps(m_z[i], maxZ))
+            );
+            outside |= _mm_movemask_ps(_mm_cmplt_ps(distance, _mm_setzero_ps()));
+        }
+        return outside == 0;
+    }
+
+    // Normalized, left, right, bottom, top, near, far. For culling on the GPU.
+    const std::array<glm::vec4, 6>& GetPlanes() const
+    {
+        return m_planes;
+    }
+
+  private:
+    static constexpr int m_planeCount = 6;
+    static constexpr int m_groupCount = (m_planeCount + 3) / 4;
+    static constexpr int m_laneCount  = m_groupCount * 4;
+
+    __m128 m_x[m_groupCount];
+    __m128 m_y[m_groupCount];
+    __m128 m_z[m_groupCount];
+    __m128 m_w[m_groupCount];
+
+    std::array<glm::vec4, m_planeCount> m_planes;
+};
+} // namespace drive
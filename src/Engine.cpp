@@ -15,12 +15,13 @@
 
 namespace drive
 {
-Engine::Engine(RendererType rendererType)
+Engine::Engine(RendererType rendererType, TerrainSettings terrainSettings)
 {
     LOG_INFO("Creating Engine");
 
     Time::SetStart();
 
+    m_jobSystem     = std::make_shared<JobSystem>();
     m_inputSettings = std::make_shared<InputSettings>();
     m_window        = std::make_shared<Window>(m_inputSettings);
     m_camera        = std::make_shared<NoclipCamera>();
@@ -35,7 +36,7 @@ Engine::Engine(RendererType rendererType)
 
         case RendererType::VULKAN:
         {
-            m_renderer = std::make_shared<VulkanRenderer>(m_window);
+            m_renderer = std::make_shared<VulkanRenderer>(m_window, m_jobSystem);
             break;
         }
 
@@ -45,8 +46,10 @@ Engine::Engine(RendererType rendererType)
         }
     }
 
-    m_ui    = std::make_unique<UI>(m_window, m_renderer);
-    m_world = std::make_shared<World>(m_renderer);
+    m_world = std::make_shared<World>(m_renderer, m_jobSystem, terrainSettings);
+    m_ui    = std::make_unique<UI>(m_window, m_renderer, m_world);
+
+    m_camera->SetClipPlanes(CAM_NEAR, m_world->GetViewDistance());
 
     m_frameInput.Clear();
     m_tickInput.Clear();
@@ -233,7 +236,7 @@ void Engine::RenderThread(const std::stop_token token)
         m_renderer->Begin();
         m_renderer->UpdateUniforms(m_camera);
 
-        m_world->Render();
+        m_world->Render(m_camera);
 
         m_ui->Render();
 
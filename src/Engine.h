@@ -8,6 +8,7 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/vec3.hpp>
 
+#include "Jobs/JobSystem.h"
 #include "Renderer/Renderer.h"
 #include "UI/UI.h"
 #include "Window/Input.h"
@@ -19,7 +20,7 @@ namespace drive
 class Engine
 {
   public:
-    Engine(RendererType rendererType);
+    Engine(RendererType rendererType, TerrainSettings terrainSettings);
     ~Engine();
 
   private:
@@ -31,6 +32,7 @@ class Engine
     void TickThread(const std::stop_token token);
     void RenderThread(const std::stop_token token);
 
+    std::shared_ptr<JobSystem>     m_jobSystem;
     std::shared_ptr<InputSettings> m_inputSettings;
     std::shared_ptr<Window>        m_window;
     std::shared_ptr<Camera>        m_camera;
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <functional>
+
+#include "../Log.h"
+#include "JobSystem.h"
+
+namespace drive
+{
+// Queue index of the current thread if it is a worker.
+static thread_local const JobSystem* t_jobSystem = nullptr;
+static thread_local unsigned int     t_workerIndex;
+
+JobSystem::JobSystem() :
+    JobSystem(
+        std::max(std::thread::hardware_concurrency(), m_reservedThreads + 1) - m_reservedThreads
+    )
+{
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+{
+    workerCount = std::max(workerCount, 1u);
+
+    LOG_INFO("Creating JobSystem with {} workers", workerCount);
+
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        m_workers.emplace_back(std::bind_front(&JobSystem::WorkerThread, this), i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    LOG_INFO("Destroying JobSystem");
+
+    for (auto& worker : m_workers)
+    {
+        worker.request_stop();
+    }
+    m_wake.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    for (const auto& queue : m_queues)
+    {
+        if (!queue->tasks.empty())
+        {
+            LOG_WARNING("Dropping {} unfinished jobs", queue->tasks.size());
+        }
+    }
+}
+
+void JobSystem::Schedule(Job job, JobCounter* counter)
+{
+    if (counter != nullptr)
+    {
+        counter->m_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Workers push to their own queue, other threads spread jobs round-robin.
+    unsigned int index;
+    if (t_jobSystem == this)
+    {
+        index = t_workerIndex;
+    }
+    else
+    {
+        index = m_nextQueue.fetch_add(1, std::memory_order_relaxed)
+                % static_cast<unsigned int>(m_queues.size());
+    }
+
+    {
+        auto&            queue = *m_queues[index];
+        std::scoped_lock lock {queue.mutex};
+        queue.tasks.push_back({std::move(job), counter});
+    }
+
+    {
+        std::scoped_lock lock {m_sleepMutex};
+        m_queuedTasks.fetch_add(1, std::memory_order_release);
+    }
+    m_wake.notify_one();
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    const auto index = t_jobSystem == this ? t_workerIndex : 0;
+
+    while (!counter.IsDone())
+    {
+        if (!RunTask(index))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::WorkerThread(const std::stop_token token, unsigned int index)
+{
+    t_jobSystem   = this;
+    t_workerIndex = index;
+
+    while (!token.stop_requested())
+    {
+        if (RunTask(index))
+        {
+            continue;
+        }
+
+        std::unique_lock lock {m_sleepMutex};
+        m_wake.wait(lock, token, [this]() {
+            return m_queuedTasks.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+bool JobSystem::PopTask(unsigned int index, Task& task)
+{
+    auto&            queue = *m_queues[index];
+    std::scoped_lock lock {queue.mutex};
+
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool JobSystem::StealTask(unsigned int thief, Task& task)
+{
+    const auto queueCount = static_cast<unsigned int>(m_queues.size());
+
+    for (unsigned int i = 1; i < queueCount; i++)
+    {
+        auto&            queue = *m_queues[(thief + i) % queueCount];
+        std::scoped_lock lock {queue.mutex};
+
+        if (queue.tasks.empty())
+        {
+            continue;
+        }
+
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    return false;
+}
+
+bool JobSystem::RunTask(unsigned int index)
+{
+    Task task;
+    if (!PopTask(index, task) && !StealTask(index, task))
+    {
+        return false;
+    }
+
+    m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+    task.job();
+
+    if (task.counter != nullptr)
+    {
+        task.counter->m_count.fetch_sub(1, std::memory_order_release);
+    }
+
+    return true;
+}
+} // namespace drive
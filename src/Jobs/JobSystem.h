@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace drive
+{
+using Job = std::function<void()>;
+
+// Tracks completion of a group of scheduled jobs.
+class JobCounter
+{
+  public:
+    JobCounter() = default;
+
+    JobCounter(const JobCounter&)            = delete;
+    JobCounter(JobCounter&&)                 = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+    JobCounter& operator=(JobCounter&&)      = delete;
+
+    bool IsDone() const
+    {
+        return m_count.load(std::memory_order_acquire) == 0;
+    }
+
+  private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> m_count {0};
+};
+
+// Work-stealing thread pool.
+// Every worker owns a deque: it pushes and pops its own jobs at the back
+// and idle workers steal from the front of the others.
+class JobSystem
+{
+  public:
+    JobSystem();
+    JobSystem(unsigned int workerCount);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&)            = delete;
+    JobSystem(JobSystem&&)                 = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem& operator=(JobSystem&&)      = delete;
+
+    // Queue a job, optionally incrementing counter until it has run.
+    void Schedule(Job job, JobCounter* counter = nullptr);
+
+    // Run queued jobs on the calling thread until counter reaches zero.
+    void Wait(JobCounter& counter);
+
+    unsigned int GetWorkerCount() const
+    {
+        return static_cast<unsigned int>(m_workers.size());
+    }
+
+  private:
+    struct Task
+    {
+        Job         job;
+        JobCounter* counter;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerThread(const std::stop_token token, unsigned int index);
+
+    bool PopTask(unsigned int index, Task& task);
+    bool StealTask(unsigned int thief, Task& task);
+    bool RunTask(unsigned int index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::jthread>                 m_workers;
+
+    std::atomic<uint32_t> m_queuedTasks {0};
+    std::atomic<uint32_t> m_nextQueue {0};
+
+    std::mutex                  m_sleepMutex;
+    std::condition_variable_any m_wake;
+
+    // Threads with their own thread (main, tick, render).
+    static constexpr unsigned int m_reservedThreads = 3;
+};
+} // namespace drive
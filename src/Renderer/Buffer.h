@@ -13,12 +13,18 @@ enum BufferType
     VertexBuffer,
     IndexBuffer,
     UniformBuffer,
+    StorageBuffer,
+    // Draw parameters written by compute, see Renderer::DrawTerrain.
+    IndirectBuffer,
 };
 
 enum BufferLocation
 {
     Host,
     Device,
+    // Persistently mapped for writing in place, device-local when the device
+    // has host-visible VRAM (ReBAR, UMA), otherwise staging memory.
+    Mapped,
 };
 
 class Buffer
@@ -67,6 +73,7 @@ class Buffer
     }
 
     virtual void Write(void* data, size_t size) = 0;
+    virtual void Read(void* data, size_t size)  = 0;
 
     virtual void CopyToDevice(void* commandBuffer, std::shared_ptr<Buffer> deviceBuffer) = 0;
 
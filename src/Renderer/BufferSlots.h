@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Buffer.h"
+
+namespace drive
+{
+class BufferSlots;
+
+// One fixed-size range of a BufferSlots buffer, free again once the last reference is gone.
+// Hold it for as long as the GPU may read the range, see Renderer::KeepForFrame.
+struct BufferSlot
+{
+    std::shared_ptr<BufferSlots> slots;
+    uint32_t                     firstElement;
+    // Into the mapped buffer, nullptr if it isn't mapped.
+    void* mappedData;
+
+    ~BufferSlot();
+};
+
+// Fixed-size ranges of one buffer, for meshes that all have the same number of elements
+// so they share a single allocation and bind. Thread-safe.
+class BufferSlots : public std::enable_shared_from_this<BufferSlots>
+{
+  public:
+    BufferSlots() = delete;
+    // mappedData is the start of the buffer if it's persistently mapped, nullptr otherwise.
+    BufferSlots(
+        std::shared_ptr<Buffer> buffer,
+        uint32_t                slotElements,
+        uint32_t                slotCount,
+        void*                   mappedData
+    ) :
+        m_buffer(std::move(buffer)),
+        m_slotElements(slotElements),
+        m_slotCount(slotCount),
+        m_slotBytes(slotElements * m_buffer->GetElementSize()),
+        m_mappedData(static_cast<uint8_t*>(mappedData))
+    {
+        // Handed out from the back, lowest slots first.
+        m_freeSlots.reserve(m_slotCount);
+        for (uint32_t i = m_slotCount; i > 0; i--)
+        {
+            m_freeSlots.push_back(i - 1);
+        }
+    }
+
+    BufferSlots(const BufferSlots&)            = delete;
+    BufferSlots(BufferSlots&&)                 = delete;
+    BufferSlots& operator=(const BufferSlots&) = delete;
+    BufferSlots& operator=(BufferSlots&&)      = delete;
+
+    // nullptr when every slot is in use.
+    std::shared_ptr<BufferSlot> Acquire()
+    {
+        uint32_t slot;
+        {
+            std::scoped_lock lock {m_mutex};
+            if (m_freeSlots.empty())
+            {
+                return nullptr;
+            }
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+
+        const uint32_t firstElement = slot * m_slotElements;
+        void*          mappedData   = nullptr;
+        if (m_mappedData != nullptr)
+        {
+            mappedData = m_mappedData + slot * m_slotBytes;
+        }
+
+        return std::make_shared<BufferSlot>(shared_from_this(), firstElement, mappedData);
+    }
+
+    const std::shared_ptr<Buffer>& GetBuffer() const
+    {
+        return m_buffer;
+    }
+
+    uint32_t GetSlotElements() const
+    {
+        return m_slotElements;
+    }
+
+    uint32_t GetSlotCount() const
+    {
+        return m_slotCount;
+    }
+
+    bool IsMapped() const
+    {
+        return m_mappedData != nullptr;
+    }
+
+    uint32_t GetFree() const
+    {
+        std::scoped_lock lock {m_mutex};
+        return static_cast<uint32_t>(m_freeSlots.size());
+    }
+
+  private:
+    friend struct BufferSlot;
+
+    void Release(uint32_t firstElement)
+    {
+        std::scoped_lock lock {m_mutex};
+        m_freeSlots.push_back(firstElement / m_slotElements);
+    }
+
+    std::shared_ptr<Buffer> m_buffer;
+    uint32_t                m_slotElements;
+    uint32_t                m_slotCount;
+    size_t                  m_slotBytes;
+    uint8_t*                m_mappedData;
+
+    mutable std::mutex    m_mutex;
+    std::vector<uint32_t> m_freeSlots;
+};
+
+inline BufferSlot::~BufferSlot()
+{
+    slots->Release(firstElement);
+}
+} // namespace drive
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <memory>
 
 #include <glm/ext/matrix_clip_space.hpp>
@@ -11,6 +14,7 @@
 #include <glm/mat4x4.hpp>
 #include <glm/matrix.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 
 #include "../Components/Camera.h"
 #include "../Log.h"
@@ -35,6 +39,102 @@ struct Vertex_P_N_C
     glm::vec3 color;
 };
 
+// Packed terrain grid vertex, x/y come from the vertex index (see Terrain.vert).
+struct Vertex_Terrain
+{
+    int16_t  normal[2]; // Octahedral, R16G16_SNORM
+    uint16_t height;    // Fraction of TerrainPushConstants::heightScale, R16_UNORM
+    uint16_t material;  // TerrainMaterial, R16_UINT
+
+    // Same conversions as GLSL packSnorm2x16 / packUnorm2x16.
+    static int16_t PackSnorm(float v)
+    {
+        return static_cast<int16_t>(std::round(std::clamp(v, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    static uint16_t PackUnorm(float v)
+    {
+        return static_cast<uint16_t>(std::round(std::clamp(v, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    void SetNormal(glm::vec3 n)
+    {
+        n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+
+        glm::vec2 e = glm::vec2(n.x, n.y);
+        if (n.z < 0.0f)
+        {
+            e = glm::vec2(
+                (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f)
+            );
+        }
+
+        normal[0] = PackSnorm(e.x);
+        normal[1] = PackSnorm(e.y);
+    }
+};
+static_assert(sizeof(Vertex_Terrain) == 8);
+
+// Per chunk, matches Terrain.vert.
+struct TerrainPushConstants
+{
+    glm::vec2 origin;
+    float     spacing;
+    float     heightScale;
+    uint32_t  verticesPerSide;
+    float     skirtDepth; // How far skirt vertices hang below the edge
+};
+
+// Per chunk drawn through TerrainCull.comp, matches TerrainDraw.glsl.
+struct TerrainDraw
+{
+    glm::vec2 origin;
+    float     spacing;
+    float     skirtDepth;
+    glm::vec3 boundsMin; // World space, skirts included
+    uint32_t  verticesPerSide;
+    glm::vec3 boundsMax;
+    int32_t   vertexOffset; // Of the chunk in the shared vertex buffer
+};
+static_assert(sizeof(TerrainDraw) == 48);
+
+// Matches TerrainIndirect.vert, the rest comes from TerrainDraw.
+struct TerrainIndirectPushConstants
+{
+    float heightScale;
+};
+
+// Per frame, matches TerrainCull.comp.
+struct TerrainCullPushConstants
+{
+    glm::vec4 planes[6]; // See Frustum::GetPlanes
+    uint32_t  firstDraw;
+    uint32_t  drawCount;
+    uint32_t  indexCount;
+    uint32_t  countIndex;
+};
+
+// Per chunk, matches TerrainGen.comp.
+// Noise and height parameters mirror the CPU generator in Terrain.h.
+struct TerrainGenPushConstants
+{
+    glm::vec2 origin;
+    float     spacing;
+    uint32_t  verticesPerSide;
+    float     noiseScale;
+    float     terrainHeight;
+    float     roadHeight;
+    float     roadThreshold;
+    float     heightScale; // Vertex_Terrain::height range
+    uint32_t  skirts;      // Append a skirt vertex per edge vertex, see GenerateGridIndices
+
+    uint32_t VertexCount() const
+    {
+        return verticesPerSide * (verticesPerSide + 4 * skirts);
+    }
+};
+
 // For fullscreen triangle
 struct VertexEmpty
 {
@@ -72,6 +72,10 @@ class EmptyRenderer final : public Renderer
     {
     }
 
+    void PushConstants(const void* /*data*/, uint32_t /*size*/) override
+    {
+    }
+
     void CreateBuffer(
         std::shared_ptr<Buffer>& /*buffer*/,
         BufferType /*bufferType*/,
@@ -81,5 +85,85 @@ class EmptyRenderer final : public Renderer
     ) override
     {
     }
+
+    bool CreateMappedBuffer(
+        std::shared_ptr<Buffer>& /*buffer*/,
+        BufferType /*bufferType*/,
+        uint32_t /*elementSize*/,
+        uint32_t /*elementCount*/,
+        void** /*data*/
+    ) override
+    {
+        return false;
+    }
+
+    void SubmitMappedBuffer(
+        std::shared_ptr<Buffer>& /*buffer*/,
+        const std::shared_ptr<Buffer>& /*mappedBuffer*/
+    ) override
+    {
+    }
+
+    bool CreateSlotBuffer(
+        std::shared_ptr<Buffer>& /*buffer*/,
+        BufferType /*bufferType*/,
+        uint32_t /*elementSize*/,
+        uint32_t /*elementCount*/,
+        void** /*data*/
+    ) override
+    {
+        return false;
+    }
+
+    void WriteBuffer(
+        const std::shared_ptr<Buffer>& /*buffer*/,
+        uint32_t /*firstElement*/,
+        const void* /*data*/,
+        uint32_t /*elementCount*/
+    ) override
+    {
+    }
+
+    void CopyBuffer(
+        const std::shared_ptr<Buffer>& /*mappedBuffer*/,
+        const std::shared_ptr<Buffer>& /*buffer*/,
+        uint32_t /*firstElement*/
+    ) override
+    {
+    }
+
+    bool AddTerrainDraw(const TerrainDraw& /*draw*/) override
+    {
+        return false;
+    }
+
+    void DrawTerrain(
+        const std::shared_ptr<Buffer>& /*vertexBuffer*/,
+        const std::shared_ptr<Buffer>& /*indexBuffer*/,
+        const std::array<glm::vec4, 6>& /*planes*/
+    ) override
+    {
+    }
+
+    bool SetTerrainPermutation(std::span<const int32_t> /*permutation*/) override
+    {
+        return false;
+    }
+
+    bool GenerateTerrain(
+        std::shared_ptr<Buffer>& /*buffer*/,
+        const TerrainGenPushConstants& /*params*/
+    ) override
+    {
+        return false;
+    }
+
+    bool ReadTerrain(
+        const TerrainGenPushConstants& /*params*/,
+        std::vector<Vertex_Terrain>& /*vertices*/
+    ) override
+    {
+        return false;
+    }
 };
 } // namespace drive
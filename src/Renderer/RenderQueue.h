@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Buffer.h"
+#include "Renderer.h"
+
+namespace drive
+{
+// One indexed draw for a RenderQueue.
+struct DrawPacket
+{
+    // Vulkan guarantees at least this much push constant space.
+    static constexpr uint32_t maxConstantsSize = 128;
+
+    RenderPipeline pipeline;
+    // Draws of the same pipeline are grouped by material, then sorted by depth.
+    uint8_t material = 0;
+    // Distance from the camera, opaque draws go front to back.
+    float depth = 0.0f;
+
+    std::shared_ptr<Buffer> vertexBuffer {};
+    std::shared_ptr<Buffer> indexBuffer {};
+    int32_t                 vertexOffset = 0;
+
+    // Held until the GPU is done with the frame, see Renderer::KeepForFrame.
+    std::shared_ptr<void> keepAlive {};
+
+    std::array<std::byte, maxConstantsSize> constants {};
+    uint32_t                                constantsSize = 0;
+
+    // Pushed before the draw, see Renderer::PushConstants.
+    template<typename T>
+    void SetConstants(const T& data)
+    {
+        static_assert(sizeof(T) <= maxConstantsSize, "Push constants too large for a DrawPacket");
+        std::memcpy(constants.data(), &data, sizeof(T));
+        constantsSize = sizeof(T);
+    }
+};
+
+// Draws collected over a frame and recorded in sort key order: pipeline, material,
+// then depth. Pipeline and buffer binds are skipped by the renderer when already
+// bound, so each pipeline is bound once per Draw. Render thread only.
+class RenderQueue
+{
+  public:
+    RenderQueue() = default;
+
+    RenderQueue(const RenderQueue&)            = delete;
+    RenderQueue(RenderQueue&&)                 = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+    RenderQueue& operator=(RenderQueue&&)      = delete;
+
+    void Add(DrawPacket packet)
+    {
+        m_keys.emplace_back(SortKey(packet), static_cast<uint32_t>(m_packets.size()));
+        m_packets.push_back(std::move(packet));
+    }
+
+    // Records everything added since the last Draw.
+    void Draw(Renderer& renderer)
+    {
+        std::sort(m_keys.begin(), m_keys.end());
+
+        for (const auto& [key, index] : m_keys)
+        {
+            auto& packet = m_packets[index];
+
+            renderer.BindPipeline(packet.pipeline);
+            if (packet.constantsSize > 0)
+            {
+                renderer.PushConstants(packet.constants.data(), packet.constantsSize);
+            }
+            if (packet.keepAlive)
+            {
+                renderer.KeepForFrame(std::move(packet.keepAlive));
+            }
+            renderer.DrawWithBuffers(packet.vertexBuffer, packet.indexBuffer, packet.vertexOffset);
+        }
+
+        m_keys.clear();
+        m_packets.clear();
+    }
+
+  private:
+    // Pipeline in bits 40-47, material in 32-39 and depth in 0-31.
+    // Bits of non-negative floats sort the same as their values.
+    static uint64_t SortKey(const DrawPacket& packet)
+    {
+        const auto depth = std::bit_cast<uint32_t>(std::max(packet.depth, 0.0f));
+        return static_cast<uint64_t>(packet.pipeline) << 40
+               | static_cast<uint64_t>(packet.material) << 32 | depth;
+    }
+
+    // Sort keys with the index of their packet, sorted instead of the packets.
+    std::vector<std::pair<uint64_t, uint32_t>> m_keys;
+    std::vector<DrawPacket>                    m_packets;
+};
+} // namespace drive
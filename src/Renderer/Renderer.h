@@ -1,14 +1,21 @@
 #pragma once
 
+#include <array>
+#include <map>
 #include <memory>
+#include <span>
+#include <utility>
+#include <vector>
 
 #include <glm/gtc/quaternion.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 
 #include "../Components/Camera.h"
 #include "../Components/Rect.h"
 #include "../Window/Window.h"
 #include "Buffer.h"
+#include "DataTypes.h"
 
 namespace drive
 {
@@ -18,10 +25,14 @@ enum RendererType
     VULKAN,
 };
 
+// A RenderQueue draws queued pipelines in this order. TERRAIN_INDIRECT is never
+// queued, it's drawn directly, see Terrain::Render.
 enum RenderPipeline
 {
     TEST,
     TERRAIN,
+    TERRAIN_INDIRECT, // Chunks drawn by DrawTerrain
+    LIT,
     FULLSCREEN,
     SKY,
 };
@@ -50,7 +61,11 @@ class Renderer
     virtual RendererType Type() const                                         = 0;
     virtual void         WaitForIdle()                                        = 0;
     virtual void*        GetCommandBuffer()                                   = 0;
-    virtual void         BindPipeline(RenderPipeline pipe)                    = 0;
+    // Also binds the descriptor set, skipped if pipe is already bound.
+    virtual void BindPipeline(RenderPipeline pipe) = 0;
+
+    // Push constants for the bound pipeline.
+    virtual void PushConstants(const void* data, uint32_t size) = 0;
 
     virtual void CreateBuffer(
         std::shared_ptr<Buffer>& buffer,
@@ -60,21 +75,220 @@ class Renderer
         uint32_t                 elementCount
     ) = 0;
 
-    void DrawWithBuffers(std::shared_ptr<Buffer> vertexBuffer, std::shared_ptr<Buffer> indexBuffer)
+    // Buffer for the CPU to fill in place through data, see BufferLocation::Mapped.
+    // Thread-safe. Return false if the renderer has no mapped buffers.
+    virtual bool CreateMappedBuffer(
+        std::shared_ptr<Buffer>& buffer,
+        BufferType               bufferType,
+        uint32_t                 elementSize,
+        uint32_t                 elementCount,
+        void**                   data
+    ) = 0;
+    // Makes a filled mapped buffer usable by the GPU as buffer, which is the mapped buffer
+    // itself when it's device-local, a copy otherwise. Call from the render thread.
+    virtual void SubmitMappedBuffer(
+        std::shared_ptr<Buffer>&       buffer,
+        const std::shared_ptr<Buffer>& mappedBuffer
+    ) = 0;
+
+    // Single buffer for fixed-size meshes, see BufferSlots. Persistently mapped through
+    // data when the device has host-visible VRAM, data is null otherwise.
+    // Return false if the renderer has no slot buffers.
+    virtual bool CreateSlotBuffer(
+        std::shared_ptr<Buffer>& buffer,
+        BufferType               bufferType,
+        uint32_t                 elementSize,
+        uint32_t                 elementCount,
+        void**                   data
+    ) = 0;
+    // Upload into an existing buffer from firstElement on. Call from the render thread.
+    virtual void WriteBuffer(
+        const std::shared_ptr<Buffer>& buffer,
+        uint32_t                       firstElement,
+        const void*                    data,
+        uint32_t                       elementCount
+    ) = 0;
+    // Same as WriteBuffer from a filled mapped buffer, see CreateMappedBuffer.
+    virtual void CopyBuffer(
+        const std::shared_ptr<Buffer>& mappedBuffer,
+        const std::shared_ptr<Buffer>& buffer,
+        uint32_t                       firstElement
+    ) = 0;
+
+    // GPU-driven terrain, see TerrainCull.comp. Queues a chunk for the next DrawTerrain,
+    // with vertexOffset into the vertex buffer it's given. Return false if the renderer
+    // can't cull on the GPU or the frame's draws are full, draw the chunk directly then.
+    virtual bool AddTerrainDraw(const TerrainDraw& draw) = 0;
+    // Culls the draws queued this frame against planes (see Frustum::GetPlanes) on the GPU
+    // and draws the visible ones with one indirect draw. Once per frame, after binding
+    // TERRAIN_INDIRECT and pushing its constants.
+    virtual void DrawTerrain(
+        const std::shared_ptr<Buffer>&  vertexBuffer,
+        const std::shared_ptr<Buffer>&  indexBuffer,
+        const std::array<glm::vec4, 6>& planes
+    ) = 0;
+
+    // Terrain generation on the GPU, see TerrainGen.comp.
+    // Return false if the renderer can't generate terrain.
+    virtual bool SetTerrainPermutation(std::span<const int32_t> permutation) = 0;
+    virtual bool GenerateTerrain(
+        std::shared_ptr<Buffer>&       buffer,
+        const TerrainGenPushConstants& params
+    ) = 0;
+    // Same as GenerateTerrain but reads the vertices back, for validation.
+    virtual bool ReadTerrain(
+        const TerrainGenPushConstants& params,
+        std::vector<Vertex_Terrain>&   vertices
+    ) = 0;
+
+    // Draws the indices from vertexOffset on in vertexBuffer. Buffers are only bound when
+    // they change, meshes sharing a buffer (see BufferSlots) bind it once per frame.
+    void DrawWithBuffers(
+        std::shared_ptr<Buffer> vertexBuffer,
+        std::shared_ptr<Buffer> indexBuffer,
+        int32_t                 vertexOffset = 0
+    )
     {
         auto commandBuffer = GetCommandBuffer();
         if (commandBuffer != nullptr)
+        {
+            BindBuffers(vertexBuffer, indexBuffer);
+            indexBuffer->Draw(commandBuffer, 0, indexBuffer->GetElementCount(), vertexOffset);
+        }
+    }
+
+    // Binds the buffers that aren't bound yet and keeps them for the frame.
+    void BindBuffers(
+        const std::shared_ptr<Buffer>& vertexBuffer,
+        const std::shared_ptr<Buffer>& indexBuffer
+    )
+    {
+        auto commandBuffer = GetCommandBuffer();
+        if (vertexBuffer.get() != m_boundVertexBuffer)
         {
             vertexBuffer->Bind(commandBuffer);
+            m_boundVertexBuffer = vertexBuffer.get();
+            m_frameResources.push_back(vertexBuffer);
+        }
+        if (indexBuffer.get() != m_boundIndexBuffer)
+        {
             indexBuffer->Bind(commandBuffer);
-            indexBuffer->Draw(commandBuffer);
-            m_frameBuffers.push_back(vertexBuffer);
-            m_frameBuffers.push_back(indexBuffer);
+            m_boundIndexBuffer = indexBuffer.get();
+            m_frameResources.push_back(indexBuffer);
         }
     }
 
-    // Hold so we don't call Buffer destructor
-    // while still in use by command buffer.
-    std::vector<std::shared_ptr<Buffer>> m_frameBuffers;
+    // Keeps resource alive until the GPU is done with the frame being recorded.
+    void KeepForFrame(std::shared_ptr<void> resource)
+    {
+        m_frameResources.push_back(std::move(resource));
+    }
+
+    // Immutable index buffer for an x-major grid of quadsPerSide^2 quads,
+    // shared by every mesh with that resolution. Call from the render thread.
+    // With skirts, the grid is followed by a ring of skirt triangles hanging
+    // from the edges, indexing 4 * (quadsPerSide + 1) vertices after the grid.
+    std::shared_ptr<Buffer> GetGridIndexBuffer(uint32_t quadsPerSide, bool skirts = false)
+    {
+        auto& buffer = m_gridIndexBuffers[{quadsPerSide, skirts}];
+        if (buffer == nullptr)
+        {
+            auto indices = GenerateGridIndices(quadsPerSide, skirts);
+            CreateBuffer(
+                buffer,
+                IndexBuffer,
+                indices.data(),
+                sizeof(Index),
+                static_cast<uint32_t>(indices.size())
+            );
+        }
+        return buffer;
+    }
+
+    // Hold so we don't call Buffer destructor while still in use by the
+    // frame being recorded, the renderer keeps them until its fence signals.
+    std::vector<std::shared_ptr<void>> m_frameResources;
+
+    // Bound by BindBuffers, held in m_frameResources. Reset every frame.
+    Buffer* m_boundVertexBuffer = nullptr;
+    Buffer* m_boundIndexBuffer  = nullptr;
+
+  protected:
+    static std::vector<Index> GenerateGridIndices(uint32_t quadsPerSide, bool skirts)
+    {
+        const uint32_t     verticesPerSide = quadsPerSide + 1;
+        std::vector<Index> indices(quadsPerSide * quadsPerSide * 6);
+
+        for (uint32_t x = 0; x < quadsPerSide; x++)
+        {
+            for (uint32_t y = 0; y < quadsPerSide; y++)
+            {
+                const uint32_t firstIndex  = (x * quadsPerSide + y) * 6;
+                const uint32_t firstVertex = x * verticesPerSide + y;
+
+                indices[firstIndex + 0] = {firstVertex + 0};
+                indices[firstIndex + 1] = {firstVertex + verticesPerSide};
+                indices[firstIndex + 2] = {firstVertex + 1};
+
+                indices[firstIndex + 3] = {firstVertex + 1};
+                indices[firstIndex + 4] = {firstVertex + verticesPerSide};
+                indices[firstIndex + 5] = {firstVertex + verticesPerSide + 1};
+            }
+        }
+
+        if (!skirts)
+        {
+            return indices;
+        }
+
+        // Edges in skirt vertex order: x = 0, x = last, y = 0, y = last.
+        // Each skirt vertex i hangs below the grid vertex edgeVertex(i).
+        const uint32_t last       = quadsPerSide;
+        const uint32_t firstSkirt = verticesPerSide * verticesPerSide;
+        const auto     edgeVertex = [&](uint32_t edge, uint32_t i) -> uint32_t {
+            switch (edge)
+            {
+                case 0:
+                    return i;
+                case 1:
+                    return last * verticesPerSide + i;
+                case 2:
+                    return i * verticesPerSide;
+                default:
+                    return i * verticesPerSide + last;
+            }
+        };
+
+        indices.reserve(indices.size() + 4 * quadsPerSide * 6);
+        for (uint32_t edge = 0; edge < 4; edge++)
+        {
+            // Wind so the skirt faces away from the grid.
+            const bool flip = edge == 1 || edge == 2;
+
+            for (uint32_t i = 0; i < quadsPerSide; i++)
+            {
+                const Index top0    = {edgeVertex(edge, i)};
+                const Index top1    = {edgeVertex(edge, i + 1)};
+                const Index bottom0 = {firstSkirt + edge * verticesPerSide + i};
+                const Index bottom1 = {bottom0 + 1};
+
+                if (flip)
+                {
+                    indices.insert(indices.end(), {top0, bottom0, top1});
+                    indices.insert(indices.end(), {top1, bottom0, bottom1});
+                }
+                else
+                {
+                    indices.insert(indices.end(), {top0, top1, bottom0});
+                    indices.insert(indices.end(), {top1, bottom1, bottom0});
+                }
+            }
+        }
+
+        return indices;
+    }
+
+    // Keyed by quads per side and skirts.
+    std::map<std::pair<uint32_t, bool>, std::shared_ptr<Buffer>> m_gridIndexBuffers;
 };
 } // namespace drive
@@ -71,6 +71,27 @@ constexpr std::vector<VkVertexInputAttributeDescription> GetVulkanAttributeDescr
             .offset   = offsetof(T, color),
         });
     }
+    else if constexpr (std::is_same_v<T, Vertex_Terrain>)
+    {
+        desc.push_back({
+            .location = 0,
+            .binding  = 0,
+            .format   = VK_FORMAT_R16G16_SNORM,
+            .offset   = offsetof(T, normal),
+        });
+        desc.push_back({
+            .location = 1,
+            .binding  = 0,
+            .format   = VK_FORMAT_R16_UNORM,
+            .offset   = offsetof(T, height),
+        });
+        desc.push_back({
+            .location = 2,
+            .binding  = 0,
+            .format   = VK_FORMAT_R16_UINT,
+            .offset   = offsetof(T, material),
+        });
+    }
     else if constexpr (std::is_same_v<T, VertexEmpty>)
     {
         // nada
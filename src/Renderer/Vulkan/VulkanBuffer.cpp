@@ -22,7 +22,9 @@ VulkanBuffer::VulkanBuffer(
     {
         case VertexBuffer:
         {
+            // Terrain vertices may be written by a compute shader.
             bufferInfo.usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+            bufferInfo.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
             break;
         }
 
@@ -39,6 +41,19 @@ VulkanBuffer::VulkanBuffer(
             break;
         }
 
+        case StorageBuffer:
+        {
+            bufferInfo.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+            break;
+        }
+
+        case IndirectBuffer:
+        {
+            bufferInfo.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+            bufferInfo.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+            break;
+        }
+
         default:
         {
             std::runtime_error("Unhandled buffer type");
@@ -52,7 +67,16 @@ VulkanBuffer::VulkanBuffer(
             bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
             allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
-            allocInfo.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+
+            // Host storage buffers are also used to read compute results back.
+            if (m_bufferType == StorageBuffer)
+            {
+                allocInfo.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+            }
+            else
+            {
+                allocInfo.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+            }
             allocInfo.requiredFlags |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
             allocInfo.preferredFlags |= VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
 
@@ -63,19 +87,57 @@ VulkanBuffer::VulkanBuffer(
         {
             bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 
+            // Concurrent sharing skips the queue family ownership transfer.
+            if (!m_queueFamilies.empty())
+            {
+                bufferInfo.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+                bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(m_queueFamilies.size());
+                bufferInfo.pQueueFamilyIndices   = m_queueFamilies.data();
+            }
+
             allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
             allocInfo.preferredFlags |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
             break;
         }
 
+        case Mapped:
+        {
+            // Copied out of when VMA can't place it in host-visible VRAM.
+            bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+            allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+            allocInfo.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+            allocInfo.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT;
+            allocInfo.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+            break;
+        }
+
         default:
         {
             throw std::runtime_error("Unhandled buffer destination");
         }
     }
 
-    vmaCreateBuffer(g_vma, &bufferInfo, &allocInfo, &m_vkBuffer, &m_vmaAllocation, nullptr);
+    VmaAllocationInfo allocationInfo {};
+    const auto        result = vmaCreateBuffer(
+        g_vma,
+        &bufferInfo,
+        &allocInfo,
+        &m_vkBuffer,
+        &m_vmaAllocation,
+        &allocationInfo
+    );
+
+    if (m_bufferLocation == Mapped && result == VK_SUCCESS)
+    {
+        VkMemoryPropertyFlags properties = 0;
+        vmaGetAllocationMemoryProperties(g_vma, m_vmaAllocation, &properties);
+
+        m_mappedData  = allocationInfo.pMappedData;
+        m_deviceLocal = (properties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+    }
 }
 
 VulkanBuffer::~VulkanBuffer()
@@ -92,11 +154,21 @@ void VulkanBuffer::Write(void* data, size_t size)
     vmaCopyMemoryToAllocation(g_vma, data, m_vmaAllocation, 0, size);
 }
 
-void VulkanBuffer::CopyToDevice(void* commandBuffer, std::shared_ptr<Buffer> deviceBuffer)
+void VulkanBuffer::Read(void* data, size_t size)
 {
     if (m_bufferLocation != Host)
     {
-        throw std::runtime_error("Tried copying from a non-host buffer");
+        throw std::runtime_error("Tried reading a non-host buffer");
+    }
+
+    vmaCopyAllocationToMemory(g_vma, m_vmaAllocation, 0, data, size);
+}
+
+void VulkanBuffer::CopyToDevice(void* commandBuffer, std::shared_ptr<Buffer> deviceBuffer)
+{
+    if (m_bufferLocation == Device)
+    {
+        throw std::runtime_error("Tried copying from a device buffer");
     }
 
     if (deviceBuffer->GetLocation() != Device)
@@ -146,7 +218,7 @@ void VulkanBuffer::Clear()
 
 void VulkanBuffer::Bind(void* commandBuffer)
 {
-    if (m_bufferLocation != Device)
+    if (m_bufferLocation == Host || (m_bufferLocation == Mapped && !m_deviceLocal))
     {
         throw std::runtime_error("Tried to bind a non-device buffer");
     }
@@ -225,6 +297,17 @@ void VulkanBuffer::Draw(
     }
 }
 
+void VulkanBuffer::Flush()
+{
+    if (m_bufferLocation != Mapped)
+    {
+        throw std::runtime_error("Tried flushing a non-mapped buffer");
+    }
+
+    // Ignored by VMA for coherent memory.
+    vmaFlushAllocation(g_vma, m_vmaAllocation, 0, VK_WHOLE_SIZE);
+}
+
 void VulkanBuffer::Map(void** data)
 {
     if (m_isMapped)
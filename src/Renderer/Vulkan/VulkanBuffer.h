@@ -2,6 +2,8 @@
 
 #include <cstring>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "../Buffer.h"
 #include "VmaUsage.h"
@@ -27,6 +29,7 @@ class VulkanBuffer : public Buffer
     VulkanBuffer& operator=(VulkanBuffer&&)      = delete;
 
     void Write(void* data, size_t size) override;
+    void Read(void* data, size_t size) override;
 
     void CopyToDevice(void* commandBuffer, std::shared_ptr<Buffer> deviceBuffer) override;
 
@@ -46,8 +49,34 @@ class VulkanBuffer : public Buffer
         return m_vkBuffer;
     }
 
+    // Mapped location only, nullptr if the allocation failed.
+    void* GetMappedData() const
+    {
+        return m_mappedData;
+    }
+
+    // Whether a Mapped buffer can be used by the GPU without a copy.
+    bool IsDeviceLocal() const
+    {
+        return m_deviceLocal;
+    }
+
+    // Makes host writes to a Mapped buffer visible, no-op on coherent memory.
+    void Flush();
+
+    // Queue families Device buffers are shared by, when uploads run on a separate
+    // transfer family. Set by VulkanDevice before any buffer is created.
+    static void SetQueueFamilies(std::vector<uint32_t> queueFamilies)
+    {
+        m_queueFamilies = std::move(queueFamilies);
+    }
+
   private:
+    static inline std::vector<uint32_t> m_queueFamilies;
+
     VkBuffer      m_vkBuffer;
     VmaAllocation m_vmaAllocation;
+    void*         m_mappedData  = nullptr;
+    bool          m_deviceLocal = false;
 };
 } // namespace drive
@@ -0,0 +1,157 @@
+#include <vector>
+
+#include "../../Log.h"
+#include "VulkanCommon.h"
+#include "VulkanComputePipeline.h"
+
+namespace drive
+{
+VulkanComputePipeline::VulkanComputePipeline(
+    const VulkanDevice&             device,
+    VkPipelineShaderStageCreateInfo shaderStage,
+    uint32_t                        storageBufferCount,
+    uint32_t                        pushConstantSize
+) :
+    m_device(device)
+{
+    LOG_DEBUG("Creating VulkanComputePipeline");
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings(storageBufferCount);
+    for (uint32_t i = 0; i < storageBufferCount; i++)
+    {
+        bindings[i].binding            = i;
+        bindings[i].descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount    = 1;
+        bindings[i].stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo {};
+    layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = storageBufferCount;
+    layoutInfo.pBindings    = bindings.data();
+
+    VK_CHECK(
+        vkCreateDescriptorSetLayout(
+            m_device.GetVkDevice(),
+            &layoutInfo,
+            nullptr,
+            &m_vkDescriptorSetLayout
+        ),
+        "Failed to create compute descriptor set layout"
+    );
+
+    VkDescriptorPoolSize poolSize {};
+    poolSize.type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = storageBufferCount;
+
+    VkDescriptorPoolCreateInfo poolInfo {};
+    poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes    = &poolSize;
+    poolInfo.maxSets       = 1;
+
+    VK_CHECK(
+        vkCreateDescriptorPool(m_device.GetVkDevice(), &poolInfo, nullptr, &m_vkDescriptorPool),
+        "Failed to create compute descriptor pool"
+    );
+
+    VkDescriptorSetAllocateInfo allocInfo {};
+    allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool     = m_vkDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts        = &m_vkDescriptorSetLayout;
+
+    VK_CHECK(
+        vkAllocateDescriptorSets(m_device.GetVkDevice(), &allocInfo, &m_vkDescriptorSet),
+        "Failed to allocate compute descriptor set"
+    );
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+    pipelineLayoutInfo.sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts    = &m_vkDescriptorSetLayout;
+
+    VkPushConstantRange pushConstantRange {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset     = 0;
+    pushConstantRange.size       = pushConstantSize;
+
+    if (pushConstantSize > 0)
+    {
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+    }
+
+    VK_CHECK(
+        vkCreatePipelineLayout(
+            m_device.GetVkDevice(),
+            &pipelineLayoutInfo,
+            nullptr,
+            &m_vkPipelineLayout
+        ),
+        "Failed to create compute pipeline layout"
+    );
+
+    VkComputePipelineCreateInfo computeCreateInfo {};
+    computeCreateInfo.sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    computeCreateInfo.stage  = shaderStage;
+    computeCreateInfo.layout = m_vkPipelineLayout;
+
+    VK_CHECK(
+        vkCreateComputePipelines(
+            m_device.GetVkDevice(),
+            m_device.GetVkPipelineCache(),
+            1,
+            &computeCreateInfo,
+            nullptr,
+            &m_vkPipeline
+        ),
+        "Failed to create compute pipeline"
+    );
+}
+
+VulkanComputePipeline::~VulkanComputePipeline()
+{
+    LOG_DEBUG("Destroying VulkanComputePipeline");
+
+    vkDestroyPipeline(m_device.GetVkDevice(), m_vkPipeline, nullptr);
+    vkDestroyPipelineLayout(m_device.GetVkDevice(), m_vkPipelineLayout, nullptr);
+    vkDestroyDescriptorPool(m_device.GetVkDevice(), m_vkDescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(m_device.GetVkDevice(), m_vkDescriptorSetLayout, nullptr);
+}
+
+void VulkanComputePipeline::SetStorageBuffer(uint32_t binding, VkBuffer buffer)
+{
+    VkDescriptorBufferInfo bufferInfo {};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range  = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet descriptorWrite {};
+    descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet          = m_vkDescriptorSet;
+    descriptorWrite.dstBinding      = binding;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo     = &bufferInfo;
+
+    vkUpdateDescriptorSets(m_device.GetVkDevice(), 1, &descriptorWrite, 0, nullptr);
+}
+
+void VulkanComputePipeline::Bind(VkCommandBuffer commandBuffer)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_vkPipeline);
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_vkPipelineLayout,
+        0,
+        1,
+        &m_vkDescriptorSet,
+        0,
+        nullptr
+    );
+}
+} // namespace drive
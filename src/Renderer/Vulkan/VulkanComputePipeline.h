@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+#include "vulkan/vulkan_core.h"
+
+#include "VulkanDevice.h"
+
+namespace drive
+{
+// Compute pipeline with its own descriptor set of storage buffers,
+// binding i in set 0 is the i-th storage buffer.
+class VulkanComputePipeline
+{
+  public:
+    VulkanComputePipeline() = delete;
+    VulkanComputePipeline(
+        const VulkanDevice&             device,
+        VkPipelineShaderStageCreateInfo shaderStage,
+        uint32_t                        storageBufferCount,
+        uint32_t                        pushConstantSize = 0
+    );
+    ~VulkanComputePipeline();
+
+    VulkanComputePipeline(const VulkanComputePipeline&)            = delete;
+    VulkanComputePipeline(VulkanComputePipeline&&)                 = delete;
+    VulkanComputePipeline& operator=(const VulkanComputePipeline&) = delete;
+    VulkanComputePipeline& operator=(VulkanComputePipeline&&)      = delete;
+
+    // The set is not double buffered, only update when no submitted work uses it.
+    void SetStorageBuffer(uint32_t binding, VkBuffer buffer);
+
+    void Bind(VkCommandBuffer commandBuffer);
+
+    VkPipelineLayout GetVkPipelineLayout() const
+    {
+        return m_vkPipelineLayout;
+    }
+
+  private:
+    const VulkanDevice& m_device;
+
+    VkDescriptorSetLayout m_vkDescriptorSetLayout;
+    VkDescriptorPool      m_vkDescriptorPool;
+    VkDescriptorSet       m_vkDescriptorSet;
+
+    VkPipelineLayout m_vkPipelineLayout;
+    VkPipeline       m_vkPipeline;
+};
+} // namespace drive
@@ -1,5 +1,7 @@
+#include <array>
 #include <cstdint>
 #include <cstring>
+#include <utility>
 
 #include "../DataTypes.h"
 #include "VulkanCommon.h"
@@ -14,17 +16,27 @@ VulkanDescriptorSet::VulkanDescriptorSet(
     m_device(device),
     m_uniformBuffers(uboBuffers)
 {
-    VkDescriptorSetLayoutBinding uboBinding {};
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings {};
+
+    auto& uboBinding              = bindings[0];
     uboBinding.binding            = 0;
     uboBinding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     uboBinding.descriptorCount    = 1;
     uboBinding.stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
     uboBinding.pImmutableSamplers = nullptr;
 
+    // Only written and read when terrain is drawn indirectly.
+    auto& storageBinding              = bindings[1];
+    storageBinding.binding            = 1;
+    storageBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    storageBinding.descriptorCount    = 1;
+    storageBinding.stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
+    storageBinding.pImmutableSamplers = nullptr;
+
     VkDescriptorSetLayoutCreateInfo layoutInfo {};
     layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = 1;
-    layoutInfo.pBindings    = &uboBinding;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings    = bindings.data();
 
     const auto maxFrames = static_cast<uint32_t>(m_uniformBuffers.size());
     m_vkLayouts.resize(maxFrames);
@@ -82,6 +94,7 @@ VulkanDescriptorSet::VulkanDescriptorSet(
 VulkanDescriptorSet::~VulkanDescriptorSet()
 {
     m_uniformBuffers.clear();
+    m_storageBuffer.reset();
 
     for (auto& layout : m_vkLayouts)
     {
@@ -94,6 +107,29 @@ void VulkanDescriptorSet::UpdateUBO(uint32_t frameIndex, const UniformBufferObje
     std::memcpy(m_ubosMappedMemory[frameIndex], ubo, sizeof(UniformBufferObject));
 }
 
+void VulkanDescriptorSet::SetStorageBuffer(std::shared_ptr<VulkanBuffer> buffer)
+{
+    for (const auto& set : m_vkSets)
+    {
+        VkDescriptorBufferInfo bufferInfo {};
+        bufferInfo.buffer = buffer->GetVkBuffer();
+        bufferInfo.offset = 0;
+        bufferInfo.range  = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet descriptorWrite {};
+        descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet          = set;
+        descriptorWrite.dstBinding      = 1;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pBufferInfo     = &bufferInfo;
+
+        vkUpdateDescriptorSets(m_device.GetVkDevice(), 1, &descriptorWrite, 0, nullptr);
+    }
+    m_storageBuffer = std::move(buffer);
+}
+
 void VulkanDescriptorSet::Bind(
     VkCommandBuffer     commandBuffer,
     VkPipelineBindPoint bindPoint,
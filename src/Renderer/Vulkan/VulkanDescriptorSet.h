@@ -24,6 +24,9 @@ class VulkanDescriptorSet
 
     void UpdateUBO(uint32_t frameIndex, const UniformBufferObject* ubo);
 
+    // Binding 1 of every frame's set, only update before any frame uses it.
+    void SetStorageBuffer(std::shared_ptr<VulkanBuffer> buffer);
+
     void Bind(
         VkCommandBuffer     commandBuffer,
         VkPipelineBindPoint bindPoint,
@@ -42,5 +45,6 @@ class VulkanDescriptorSet
     std::vector<VkDescriptorSet>               m_vkSets;
     std::vector<std::shared_ptr<VulkanBuffer>> m_uniformBuffers;
     std::vector<void*>                         m_ubosMappedMemory;
+    std::shared_ptr<VulkanBuffer>              m_storageBuffer;
 };
 } // namespace drive
@@ -1,7 +1,9 @@
 #include "VulkanDevice.h"
 #include "../../Log.h"
+#include "VulkanBuffer.h"
 #include "VulkanCommon.h"
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <limits>
 #include <set>
@@ -56,6 +58,7 @@ VulkanDevice::VulkanDevice(const VulkanInstance& instance, uint32_t maxFramesInF
 
     PickPhysicalDevice();
     CreateLogicalDevice();
+    m_pipelineCache = std::make_unique<VulkanPipelineCache>(m_vkPhysicalDevice, m_vkDevice);
 
     CreateVulkanAllocator(m_instance.GetVkInstance(), m_vkPhysicalDevice, m_vkDevice);
 
@@ -80,6 +83,7 @@ VulkanDevice::~VulkanDevice()
     {
         vkDestroyFence(m_vkDevice, fence, nullptr);
     }
+    vkDestroyFence(m_vkDevice, m_vkTemporaryFence, nullptr);
     for (auto& semaphore : m_vkImageSemaphores)
     {
         vkDestroySemaphore(m_vkDevice, semaphore, nullptr);
@@ -95,6 +99,9 @@ VulkanDevice::~VulkanDevice()
 
     DestroyVulkanAllocator();
 
+    m_pipelineCache->Save();
+    m_pipelineCache.reset();
+
     vkDestroyDevice(m_vkDevice, nullptr);
 }
 
@@ -142,6 +149,15 @@ void VulkanDevice::Begin()
         "Failed to begin command buffer"
     );
 
+    VK_CHECK(
+        vkResetCommandBuffer(m_vkComputeCommandBuffers[m_currentFrame], 0),
+        "Failed to reset compute command buffer"
+    );
+    VK_CHECK(
+        vkBeginCommandBuffer(m_vkComputeCommandBuffers[m_currentFrame], &beginInfo),
+        "Failed to begin compute command buffer"
+    );
+
     TransitionImageLayout(
         m_vkCommandBuffers[m_currentFrame],
         m_vkSwapchainImages[m_currentImageIndex],
@@ -247,25 +263,74 @@ void VulkanDevice::Submit()
         vkEndCommandBuffer(m_vkCommandBuffers[m_currentFrame]),
         "Failed to end command buffer"
     );
+    VK_CHECK(
+        vkEndCommandBuffer(m_vkComputeCommandBuffers[m_currentFrame]),
+        "Failed to end compute command buffer"
+    );
+
+    // Compute first, its barriers cover the rendering after it.
+    const std::array commandBuffers = {
+        m_vkComputeCommandBuffers[m_currentFrame],
+        m_vkCommandBuffers[m_currentFrame],
+    };
+
+    SubmitGraphics(
+        commandBuffers,
+        m_vkImageSemaphores[m_currentFrame],
+        m_vkRenderSemaphores[m_currentFrame],
+        m_vkInFlightFences[m_currentFrame]
+    );
+}
+
+void VulkanDevice::SubmitGraphics(
+    std::span<const VkCommandBuffer> commandBuffers,
+    VkSemaphore                      imageSemaphore,
+    VkSemaphore                      renderSemaphore,
+    VkFence                          fence
+)
+{
+    std::array<VkSemaphore, 2>          waitSemaphores {};
+    std::array<VkPipelineStageFlags, 2> waitStages {};
+    std::array<uint64_t, 2>             waitValues {}; // Ignored for binary semaphores
+    uint32_t                            waitCount = 0;
+
+    if (imageSemaphore != VK_NULL_HANDLE)
+    {
+        waitSemaphores[waitCount] = imageSemaphore;
+        waitStages[waitCount]     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        waitCount++;
+    }
+
+    // Uploaded buffers are only read as vertices, indices or by compute.
+    // Later submits are ordered after this wait, it only needs to happen once.
+    if (m_vkWaitTimeline != VK_NULL_HANDLE)
+    {
+        waitSemaphores[waitCount] = m_vkWaitTimeline;
+        waitStages[waitCount] =
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        waitValues[waitCount] = m_vkWaitTimelineValue;
+        waitCount++;
+
+        m_vkWaitTimeline = VK_NULL_HANDLE;
+    }
 
-    VkSemaphore          waitSemaphores[]   = {m_vkImageSemaphores[m_currentFrame]};
-    VkPipelineStageFlags waitStages[]       = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    VkSemaphore          signalSemaphores[] = {m_vkRenderSemaphores[m_currentFrame]};
+    VkTimelineSemaphoreSubmitInfo timelineInfo {};
+    timelineInfo.sType                   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = waitCount;
+    timelineInfo.pWaitSemaphoreValues    = waitValues.data();
 
     VkSubmitInfo submitInfo {};
     submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount   = 1;
-    submitInfo.pCommandBuffers      = &m_vkCommandBuffers[m_currentFrame];
-    submitInfo.waitSemaphoreCount   = 1;
-    submitInfo.pWaitSemaphores      = waitSemaphores;
-    submitInfo.pWaitDstStageMask    = waitStages;
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores    = signalSemaphores;
-
-    VK_CHECK(
-        vkQueueSubmit(m_vkGraphicsQueue, 1, &submitInfo, m_vkInFlightFences[m_currentFrame]),
-        "Failed to submit queue"
-    );
+    submitInfo.pNext                = &timelineInfo;
+    submitInfo.commandBufferCount   = static_cast<uint32_t>(commandBuffers.size());
+    submitInfo.pCommandBuffers      = commandBuffers.data();
+    submitInfo.waitSemaphoreCount   = waitCount;
+    submitInfo.pWaitSemaphores      = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask    = waitStages.data();
+    submitInfo.signalSemaphoreCount = renderSemaphore != VK_NULL_HANDLE ? 1 : 0;
+    submitInfo.pSignalSemaphores    = &renderSemaphore;
+
+    VK_CHECK(vkQueueSubmit(m_vkGraphicsQueue, 1, &submitInfo, fence), "Failed to submit queue");
 }
 
 void VulkanDevice::Present()
@@ -301,6 +366,12 @@ void VulkanDevice::WaitForGraphicsIdle()
     vkQueueWaitIdle(m_vkGraphicsQueue);
 }
 
+void VulkanDevice::WaitForTimeline(VkSemaphore semaphore, uint64_t value)
+{
+    m_vkWaitTimeline      = semaphore;
+    m_vkWaitTimelineValue = value;
+}
+
 VkCommandBuffer VulkanDevice::GetTemporaryCommandBuffer()
 {
     VkCommandBufferAllocateInfo allocInfo {};
@@ -332,17 +403,17 @@ void VulkanDevice::SubmitTemporaryCommandBuffer(VkCommandBuffer commandBuffer)
 {
     VK_CHECK(vkEndCommandBuffer(commandBuffer), "Failed to end temporary command buffer");
 
-    VkSubmitInfo submitInfo {};
-    submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers    = &commandBuffer;
+    SubmitGraphics({&commandBuffer, 1}, VK_NULL_HANDLE, VK_NULL_HANDLE, m_vkTemporaryFence);
 
+    // Only this submit, frames in flight keep running.
     VK_CHECK(
-        vkQueueSubmit(m_vkGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE),
-        "Failed to submit temporary command buffer"
+        vkWaitForFences(m_vkDevice, 1, &m_vkTemporaryFence, VK_TRUE, UINT64_MAX),
+        "Failed waiting for temporary command buffer"
+    );
+    VK_CHECK(
+        vkResetFences(m_vkDevice, 1, &m_vkTemporaryFence),
+        "Failed to reset temporary fence"
     );
-    // TODO: wait all copies with fences?
-    WaitForGraphicsIdle();
 
     vkFreeCommandBuffers(m_vkDevice, m_vkCommandPool, 1, &commandBuffer);
 }
@@ -386,11 +457,25 @@ void VulkanDevice::PickPhysicalDevice()
     std::vector<VkPhysicalDevice> devices(deviceCount);
     vkEnumeratePhysicalDevices(m_instance.GetVkInstance(), &deviceCount, devices.data());
 
+    // Prefer a discrete GPU, but take integrated or software (lavapipe) devices over nothing.
     for (const auto& device : devices)
     {
-        if (IsDeviceSuitable(device))
+        if (!IsDeviceSuitable(device))
+        {
+            continue;
+        }
+
+        VkPhysicalDeviceProperties deviceProperties {};
+        vkGetPhysicalDeviceProperties(device, &deviceProperties);
+
+        if (m_vkPhysicalDevice == VK_NULL_HANDLE
+            || deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
         {
             m_vkPhysicalDevice = device;
+        }
+
+        if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+        {
             break;
         }
     }
@@ -399,16 +484,21 @@ void VulkanDevice::PickPhysicalDevice()
     {
         throw std::runtime_error("Failed to find a suitable GPU for vulkan");
     }
+
+    VkPhysicalDeviceProperties deviceProperties {};
+    vkGetPhysicalDeviceProperties(m_vkPhysicalDevice, &deviceProperties);
+    LOG_INFO("Using physical device '{}'", deviceProperties.deviceName);
 }
 
 bool VulkanDevice::IsDeviceSuitable(const VkPhysicalDevice device)
 {
-    VkPhysicalDeviceProperties deviceProperties {};
-    vkGetPhysicalDeviceProperties(device, &deviceProperties);
+    VkPhysicalDeviceVulkan12Features vulkan12Features {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.pNext = nullptr;
 
     VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeature {};
     dynamicRenderingFeature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
-    dynamicRenderingFeature.pNext = nullptr;
+    dynamicRenderingFeature.pNext = &vulkan12Features;
 
     VkPhysicalDeviceFeatures2 deviceFeatures {};
     deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
@@ -416,9 +506,10 @@ bool VulkanDevice::IsDeviceSuitable(const VkPhysicalDevice device)
 
     vkGetPhysicalDeviceFeatures2(device, &deviceFeatures);
 
-    auto dynamicRenderingSupported = dynamicRenderingFeature.dynamicRendering == VK_TRUE;
+    auto dynamicRenderingSupported  = dynamicRenderingFeature.dynamicRendering == VK_TRUE;
+    auto timelineSemaphoreSupported = vulkan12Features.timelineSemaphore == VK_TRUE;
 
-    auto featuresSupported = dynamicRenderingSupported;
+    auto featuresSupported = dynamicRenderingSupported && timelineSemaphoreSupported;
 
     auto familyIndices       = FindQueueFamilies(device);
     auto extensionsSupported = CheckDeviceExtensionSupport(device);
@@ -431,8 +522,7 @@ bool VulkanDevice::IsDeviceSuitable(const VkPhysicalDevice device)
             !swapchainSupport.formats.empty() && !swapchainSupport.presentModes.empty();
     }
 
-    return deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU
-           && familyIndices.IsComplete() && featuresSupported && extensionsSupported
+    return familyIndices.IsComplete() && featuresSupported && extensionsSupported
            && swapchainAdequate;
 }
 
@@ -446,10 +536,17 @@ VulkanQueueFamilyIndices VulkanDevice::FindQueueFamilies(const VkPhysicalDevice
     std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
+    // Families with transfer but no graphics are usually DMA engines that copy
+    // alongside rendering, ones without compute too are preferred.
+    bool transferOnly = false;
+
     uint32_t i = 0;
     for (const auto& family : queueFamilies)
     {
-        if (family.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        // Terrain generation dispatches compute on the graphics queue.
+        const auto graphicsCompute = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+        if (!familyIndices.graphicsFamily.has_value()
+            && (family.queueFlags & graphicsCompute) == graphicsCompute)
         {
             familyIndices.graphicsFamily = i;
         }
@@ -457,14 +554,18 @@ VulkanQueueFamilyIndices VulkanDevice::FindQueueFamilies(const VkPhysicalDevice
         VkBool32 presentSupport = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_instance.GetSurface(), &presentSupport);
 
-        if (presentSupport)
+        if (!familyIndices.presentFamily.has_value() && presentSupport)
         {
             familyIndices.presentFamily = i;
         }
 
-        if (familyIndices.IsComplete())
+        const bool transfer = (family.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0;
+        const bool graphics = (family.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        const bool compute  = (family.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+        if (transfer && !graphics && !transferOnly)
         {
-            break;
+            familyIndices.transferFamily = i;
+            transferOnly                 = !compute;
         }
 
         i++;
@@ -755,7 +856,8 @@ void VulkanDevice::CreateLogicalDevice()
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t>                   uniqueQueueFamilies = {
         familyIndices.graphicsFamily.value(),
-        familyIndices.presentFamily.value()
+        familyIndices.presentFamily.value(),
+        familyIndices.transferFamily.value_or(familyIndices.graphicsFamily.value())
     };
 
     auto queuePriority = 1.0f;
@@ -769,14 +871,38 @@ void VulkanDevice::CreateLogicalDevice()
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    // Indirect terrain draws are optional, see Renderer::DrawTerrain.
+    VkPhysicalDeviceVulkan12Features supported12Features {};
+    supported12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supportedFeatures {};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = &supported12Features;
+
+    vkGetPhysicalDeviceFeatures2(m_vkPhysicalDevice, &supportedFeatures);
+
+    m_indirectDrawSupported = supportedFeatures.features.multiDrawIndirect == VK_TRUE
+                              && supportedFeatures.features.drawIndirectFirstInstance == VK_TRUE
+                              && supported12Features.drawIndirectCount == VK_TRUE;
+    const VkBool32 indirectDraw = m_indirectDrawSupported ? VK_TRUE : VK_FALSE;
+    LOG_INFO("Indirect draw count {}", m_indirectDrawSupported ? "supported" : "not supported");
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features {};
+    vulkan12Features.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+    vulkan12Features.drawIndirectCount = indirectDraw;
+    vulkan12Features.pNext             = nullptr;
+
     VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeature {};
     dynamicRenderingFeature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
     dynamicRenderingFeature.dynamicRendering = VK_TRUE;
-    dynamicRenderingFeature.pNext            = nullptr;
+    dynamicRenderingFeature.pNext            = &vulkan12Features;
 
     VkPhysicalDeviceFeatures2 deviceFeatures {};
     deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     deviceFeatures.pNext = &dynamicRenderingFeature;
+    deviceFeatures.features.multiDrawIndirect         = indirectDraw;
+    deviceFeatures.features.drawIndirectFirstInstance = indirectDraw;
 
     VkDeviceCreateInfo deviceCreateInfo {};
     deviceCreateInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -794,8 +920,22 @@ void VulkanDevice::CreateLogicalDevice()
 
     m_vkGraphicsQueueIndex = familyIndices.graphicsFamily.value();
     m_vkPresentQueueIndex  = familyIndices.presentFamily.value();
+    m_vkTransferQueueIndex = familyIndices.transferFamily.value_or(m_vkGraphicsQueueIndex);
     vkGetDeviceQueue(m_vkDevice, m_vkGraphicsQueueIndex, 0, &m_vkGraphicsQueue);
     vkGetDeviceQueue(m_vkDevice, m_vkPresentQueueIndex, 0, &m_vkPresentQueue);
+    vkGetDeviceQueue(m_vkDevice, m_vkTransferQueueIndex, 0, &m_vkTransferQueue);
+
+    LOG_INFO(
+        "Uploading on {} queue family {}",
+        familyIndices.transferFamily.has_value() ? "transfer" : "graphics",
+        m_vkTransferQueueIndex
+    );
+
+    // Device buffers are written on the transfer queue and read on the graphics one.
+    if (m_vkTransferQueueIndex != m_vkGraphicsQueueIndex)
+    {
+        VulkanBuffer::SetQueueFamilies({m_vkGraphicsQueueIndex, m_vkTransferQueueIndex});
+    }
 }
 
 void VulkanDevice::CreateCommandPool()
@@ -827,6 +967,12 @@ void VulkanDevice::CreateCommandBuffers()
         vkAllocateCommandBuffers(m_vkDevice, &allocInfo, m_vkCommandBuffers.data()),
         "Failed to allocate command buffers"
     );
+
+    m_vkComputeCommandBuffers.resize(m_maxFramesInFlight);
+    VK_CHECK(
+        vkAllocateCommandBuffers(m_vkDevice, &allocInfo, m_vkComputeCommandBuffers.data()),
+        "Failed to allocate compute command buffers"
+    );
 }
 
 void VulkanDevice::CreateSyncObjects()
@@ -857,18 +1003,29 @@ void VulkanDevice::CreateSyncObjects()
             "Failed to create in flight fence"
         );
     }
+
+    VkFenceCreateInfo temporaryFenceInfo {};
+    temporaryFenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VK_CHECK(
+        vkCreateFence(m_vkDevice, &temporaryFenceInfo, nullptr, &m_vkTemporaryFence),
+        "Failed to create temporary fence"
+    );
 }
 
 void VulkanDevice::CreateDescriptorPools()
 {
-    VkDescriptorPoolSize uboPoolSize {};
-    uboPoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboPoolSize.descriptorCount = m_maxFramesInFlight;
+    // Uniforms and the terrain draw list, see VulkanDescriptorSet.
+    std::array<VkDescriptorPoolSize, 2> uboPoolSizes {};
+    uboPoolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uboPoolSizes[0].descriptorCount = m_maxFramesInFlight;
+    uboPoolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    uboPoolSizes[1].descriptorCount = m_maxFramesInFlight;
 
     VkDescriptorPoolCreateInfo uboPoolInfo {};
     uboPoolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    uboPoolInfo.poolSizeCount = 1;
-    uboPoolInfo.pPoolSizes    = &uboPoolSize;
+    uboPoolInfo.poolSizeCount = static_cast<uint32_t>(uboPoolSizes.size());
+    uboPoolInfo.pPoolSizes    = uboPoolSizes.data();
     uboPoolInfo.maxSets       = m_maxFramesInFlight;
 
     VK_CHECK(
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <memory>
 #include <optional>
+#include <span>
 
 #include "../../Components/Rect.h"
 #include "VmaUsage.h"
 #include "VulkanInstance.h"
+#include "VulkanPipelineCache.h"
 
 namespace drive
 {
@@ -12,6 +15,8 @@ struct VulkanQueueFamilyIndices
 {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    // Transfer-only family for uploads, if the device has one.
+    std::optional<uint32_t> transferFamily;
 
     bool IsComplete() const
     {
@@ -44,6 +49,10 @@ class VulkanDevice
     void Present();
     void WaitForGraphicsIdle();
 
+    // The next graphics submit waits for the timeline semaphore to reach value
+    // before reading vertices, indices or storage buffers.
+    void WaitForTimeline(VkSemaphore semaphore, uint64_t value);
+
     VkCommandBuffer GetTemporaryCommandBuffer();
     void            SubmitTemporaryCommandBuffer(VkCommandBuffer commandBuffer);
 
@@ -52,6 +61,19 @@ class VulkanDevice
         return m_vkCommandBuffers[m_currentFrame];
     }
 
+    // Recorded alongside the frame's command buffer and submitted before it, for
+    // compute that has to run outside rendering but within the frame.
+    VkCommandBuffer GetComputeCommandBuffer() const
+    {
+        return m_vkComputeCommandBuffers[m_currentFrame];
+    }
+
+    // multiDrawIndirect, drawIndirectFirstInstance and drawIndirectCount.
+    bool SupportsIndirectDraw() const
+    {
+        return m_indirectDrawSupported;
+    }
+
     uint32_t GetCurrentFrame() const
     {
         return m_currentFrame;
@@ -72,6 +94,17 @@ class VulkanDevice
         return m_vkDevice;
     }
 
+    // Pass to every pipeline creation, saved when the device is destroyed.
+    VkPipelineCache GetVkPipelineCache() const
+    {
+        return m_pipelineCache->GetVkPipelineCache();
+    }
+
+    bool IsPipelineCacheWarm() const
+    {
+        return m_pipelineCache->IsWarm();
+    }
+
     constexpr VkExtent2D GetSwapchainExtent() const
     {
         return m_vkSwapchainExtent;
@@ -113,7 +146,26 @@ class VulkanDevice
         return m_vkGraphicsQueue;
     }
 
+    // Same as the graphics queue when there's no dedicated transfer family.
+    uint32_t GetTransferQueueIndex() const
+    {
+        return m_vkTransferQueueIndex;
+    }
+
+    VkQueue GetTransferQueue() const
+    {
+        return m_vkTransferQueue;
+    }
+
   private:
+    // Also waits for the timeline set by WaitForTimeline, semaphores may be null.
+    void SubmitGraphics(
+        std::span<const VkCommandBuffer> commandBuffers,
+        VkSemaphore                      imageSemaphore,
+        VkSemaphore                      renderSemaphore,
+        VkFence                          fence
+    );
+
     void RecreateSwapchain();
     void DestroySwapchain();
 
@@ -163,11 +215,15 @@ class VulkanDevice
     VkPhysicalDevice m_vkPhysicalDevice;
     VkDevice         m_vkDevice;
 
+    std::unique_ptr<VulkanPipelineCache> m_pipelineCache;
+
     uint32_t m_vkGraphicsQueueIndex;
     uint32_t m_vkPresentQueueIndex;
+    uint32_t m_vkTransferQueueIndex;
 
     VkQueue m_vkGraphicsQueue;
     VkQueue m_vkPresentQueue;
+    VkQueue m_vkTransferQueue;
 
     VkSwapchainKHR           m_vkSwapchain;
     std::vector<VkImage>     m_vkSwapchainImages;
@@ -181,10 +237,15 @@ class VulkanDevice
 
     VkCommandPool                m_vkCommandPool;
     std::vector<VkCommandBuffer> m_vkCommandBuffers;
+    std::vector<VkCommandBuffer> m_vkComputeCommandBuffers;
 
     std::vector<VkSemaphore> m_vkImageSemaphores;
     std::vector<VkSemaphore> m_vkRenderSemaphores;
     std::vector<VkFence>     m_vkInFlightFences;
+    VkFence                  m_vkTemporaryFence;
+
+    VkSemaphore m_vkWaitTimeline      = VK_NULL_HANDLE;
+    uint64_t    m_vkWaitTimelineValue = 0;
 
     VkDescriptorPool m_vkUboDescriptorPool;
     VkDescriptorPool m_vkImGuiDescriptorPool;
@@ -193,7 +254,8 @@ class VulkanDevice
     uint32_t       m_currentFrame = 0;
     const uint32_t m_maxFramesInFlight;
 
-    bool m_frameBufferResized = false;
+    bool m_frameBufferResized    = false;
+    bool m_indirectDrawSupported = false;
 
     const std::vector<const char*> m_requiredExtensions = {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME,
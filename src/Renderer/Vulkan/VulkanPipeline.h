@@ -20,8 +20,9 @@ class VulkanPipeline
         const VulkanDevice&                          device,
         std::shared_ptr<VulkanDescriptorSet>         descriptorSet,
         std::vector<VkPipelineShaderStageCreateInfo> shaderStages,
-        bool                                         enableCulling = true,
-        bool                                         enableDepth   = true
+        bool                                         enableCulling    = true,
+        bool                                         enableDepth      = true,
+        uint32_t                                     pushConstantSize = 0
     );
     ~VulkanPipeline();
 
@@ -37,6 +38,11 @@ class VulkanPipeline
         return m_vkPipeline;
     }
 
+    VkPipelineLayout GetVkPipelineLayout() const
+    {
+        return m_vkPipelineLayout;
+    }
+
   private:
     const VulkanDevice&                  m_device;
     std::shared_ptr<VulkanDescriptorSet> m_descriptorSet;
@@ -51,7 +57,8 @@ VulkanPipeline<V>::VulkanPipeline(
     std::shared_ptr<VulkanDescriptorSet>         descriptorSet,
     std::vector<VkPipelineShaderStageCreateInfo> shaderStages,
     bool                                         enableCulling,
-    bool                                         enableDepth
+    bool                                         enableDepth,
+    uint32_t                                     pushConstantSize
 ) :
     m_device(device),
     m_descriptorSet(descriptorSet)
@@ -144,6 +151,17 @@ VulkanPipeline<V>::VulkanPipeline(
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
     pipelineLayoutInfo.pSetLayouts    = descriptorSetLayouts.data();
 
+    VkPushConstantRange pushConstantRange {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.offset     = 0;
+    pushConstantRange.size       = pushConstantSize;
+
+    if (pushConstantSize > 0)
+    {
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+    }
+
     VK_CHECK(
         vkCreatePipelineLayout(
             m_device.GetVkDevice(),
@@ -196,7 +214,7 @@ VulkanPipeline<V>::VulkanPipeline(
     VK_CHECK(
         vkCreateGraphicsPipelines(
             m_device.GetVkDevice(),
-            VK_NULL_HANDLE,
+            m_device.GetVkPipelineCache(),
             1,
             &graphicsCreateInfo,
             nullptr,
@@ -0,0 +1,140 @@
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+#include "../../Log.h"
+#include "VulkanCommon.h"
+#include "VulkanPipelineCache.h"
+
+namespace drive
+{
+VulkanPipelineCache::VulkanPipelineCache(VkPhysicalDevice physicalDevice, VkDevice device) :
+    m_vkDevice(device)
+{
+    vkGetPhysicalDeviceProperties(physicalDevice, &m_properties);
+
+    // Driver updates keep the file name, the header check throws their data out.
+    const auto fileName =
+        std::format("{:04x}_{:04x}.bin", m_properties.vendorID, m_properties.deviceID);
+    m_path = std::filesystem::path(PIPELINE_CACHE_DIRECTORY) / fileName;
+
+    const auto data = Load();
+    m_warm          = !data.empty();
+
+    VkPipelineCacheCreateInfo cacheInfo {};
+    cacheInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData    = data.data();
+
+    VK_CHECK(
+        vkCreatePipelineCache(m_vkDevice, &cacheInfo, nullptr, &m_vkPipelineCache),
+        "Failed to create pipeline cache"
+    );
+
+    LOG_INFO(
+        "Pipeline cache {}, {}",
+        m_path.string(),
+        m_warm ? std::format("{} KB", data.size() / 1024) : "empty"
+    );
+}
+
+VulkanPipelineCache::~VulkanPipelineCache()
+{
+    vkDestroyPipelineCache(m_vkDevice, m_vkPipelineCache, nullptr);
+}
+
+void VulkanPipelineCache::Save()
+{
+    // Called from the device destructor, failures must not throw.
+    size_t   size   = 0;
+    VkResult result = vkGetPipelineCacheData(m_vkDevice, m_vkPipelineCache, &size, nullptr);
+    if (result != VK_SUCCESS)
+    {
+        LOG_WARNING("Failed to get pipeline cache size: {}", static_cast<int>(result));
+        return;
+    }
+
+    std::vector<char> data(size);
+    result = vkGetPipelineCacheData(m_vkDevice, m_vkPipelineCache, &size, data.data());
+    if (result != VK_SUCCESS)
+    {
+        LOG_WARNING("Failed to get pipeline cache data: {}", static_cast<int>(result));
+        return;
+    }
+    data.resize(size);
+
+    std::error_code error;
+    std::filesystem::create_directories(m_path.parent_path(), error);
+    if (error)
+    {
+        LOG_WARNING("Failed to save pipeline cache {}: {}", m_path.string(), error.message());
+        return;
+    }
+
+    // A crash mid-write leaves the previous file.
+    auto tempPath = m_path;
+    tempPath.concat(".tmp");
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file)
+        {
+            LOG_WARNING("Failed to write pipeline cache {}", tempPath.string());
+            return;
+        }
+    }
+
+    std::filesystem::rename(tempPath, m_path, error);
+    if (error)
+    {
+        LOG_WARNING("Failed to save pipeline cache {}: {}", m_path.string(), error.message());
+        std::filesystem::remove(tempPath, error);
+        return;
+    }
+
+    LOG_INFO("Saved pipeline cache {}, {} KB", m_path.string(), data.size() / 1024);
+}
+
+std::vector<char> VulkanPipelineCache::Load()
+{
+    std::ifstream file(m_path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        return {};
+    }
+
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file || !IsValid(data))
+    {
+        LOG_WARNING("Ignoring pipeline cache {} from another device or driver", m_path.string());
+        return {};
+    }
+
+    return data;
+}
+
+// Drivers should reject foreign data themselves, not all of them do.
+bool VulkanPipelineCache::IsValid(const std::vector<char>& data) const
+{
+    VkPipelineCacheHeaderVersionOne header {};
+    if (data.size() < sizeof(header))
+    {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header) && header.headerSize <= data.size()
+           && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+           && header.vendorID == m_properties.vendorID && header.deviceID == m_properties.deviceID
+           && std::memcmp(
+                  header.pipelineCacheUUID,
+                  m_properties.pipelineCacheUUID,
+                  VK_UUID_SIZE
+              ) == 0;
+}
+} // namespace drive
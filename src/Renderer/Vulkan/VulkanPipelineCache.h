@@ -0,0 +1,51 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#define PIPELINE_CACHE_DIRECTORY "cache/pipelines"
+
+namespace drive
+{
+// VkPipelineCache shared by every pipeline, loaded from and saved to a file per
+// physical device. Files from another device or driver are ignored.
+class VulkanPipelineCache
+{
+  public:
+    VulkanPipelineCache() = delete;
+    VulkanPipelineCache(VkPhysicalDevice physicalDevice, VkDevice device);
+    ~VulkanPipelineCache();
+
+    VulkanPipelineCache(const VulkanPipelineCache&)            = delete;
+    VulkanPipelineCache(VulkanPipelineCache&&)                 = delete;
+    VulkanPipelineCache& operator=(const VulkanPipelineCache&) = delete;
+    VulkanPipelineCache& operator=(VulkanPipelineCache&&)      = delete;
+
+    // Writes everything created so far to the file, failures are logged.
+    void Save();
+
+    VkPipelineCache GetVkPipelineCache() const
+    {
+        return m_vkPipelineCache;
+    }
+
+    // Whether the cache started with data from a previous run.
+    bool IsWarm() const
+    {
+        return m_warm;
+    }
+
+  private:
+    std::vector<char> Load();
+    bool              IsValid(const std::vector<char>& data) const;
+
+    VkDevice                   m_vkDevice;
+    VkPhysicalDeviceProperties m_properties;
+    VkPipelineCache            m_vkPipelineCache;
+
+    std::filesystem::path m_path;
+    bool                  m_warm = false;
+};
+} // namespace drive
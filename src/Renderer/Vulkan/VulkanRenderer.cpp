@@ -1,7 +1,13 @@
+#include <algorithm>
+#include <exception>
+#include <functional>
 #include <imgui_impl_vulkan.h>
 #include <memory>
+#include <mutex>
+#include <utility>
 
 #include "../../Log.h"
+#include "../../Time.h"
 #include "../DataTypes.h"
 #include "../Shader.h"
 #include "VulkanRenderer.h"
@@ -9,14 +15,26 @@
 namespace drive
 {
 
-#define MAX_FRAMES_IN_FLIGHT 2
-
-VulkanRenderer::VulkanRenderer(std::shared_ptr<Window> window) :
+#define MAX_FRAMES_IN_FLIGHT   2
+#define TERRAIN_GEN_GROUP_SIZE 64 // local_size_x in TerrainGen.comp
+#define TERRAIN_CULL_GROUP_SIZE 64 // local_size_x in TerrainCull.comp
+// Per frame, chunks past this are drawn directly.
+#define TERRAIN_MAX_DRAWS 16384
+// Bounds staging memory, a few frames of chunk uploads, larger ones get their own buffer.
+#define UPLOAD_STAGING_SIZE (32 * 1024 * 1024)
+
+VulkanRenderer::VulkanRenderer(
+    std::shared_ptr<Window>    window,
+    std::shared_ptr<JobSystem> jobSystem
+) :
     m_instance(window),
     m_device(m_instance, MAX_FRAMES_IN_FLIGHT)
 {
     LOG_INFO("Creating VulkanRenderer");
 
+    m_uploader = std::make_unique<VulkanUploader>(m_device, UPLOAD_STAGING_SIZE);
+    m_inFlightResources.resize(MAX_FRAMES_IN_FLIGHT);
+
     auto uboBuffers = std::vector<std::shared_ptr<VulkanBuffer>>();
     for (unsigned int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
@@ -26,7 +44,12 @@ VulkanRenderer::VulkanRenderer(std::shared_ptr<Window> window) :
     }
     m_descriptorSet = std::make_shared<VulkanDescriptorSet>(m_device, uboBuffers);
 
+    // Compare cold and warm startups, most of this is the driver compiling pipelines.
+    const double pipelineStart = Time::Now();
+
     // TODO: abstract away all the shader + pipeline setup
+    // Modules are cheap, the driver compiles when a pipeline is created. Those are
+    // spread over the job system, pipeline caches are safe to use from any thread.
     auto moduleSimpleFrag = CreateShaderModule(LOAD_VULKAN_SPV(Simple_frag));
     auto moduleSimpleVert = CreateShaderModule(LOAD_VULKAN_SPV(Simple_vert));
     auto stageSimpleFrag =
@@ -34,9 +57,6 @@ VulkanRenderer::VulkanRenderer(std::shared_ptr<Window> window) :
     auto stageSimpleVert = FillShaderStageCreateInfo(moduleSimpleVert, VK_SHADER_STAGE_VERTEX_BIT);
     std::vector simpleStages {stageSimpleFrag, stageSimpleVert};
 
-    m_testPipeline =
-        std::make_shared<VulkanPipeline<Vertex_P_C>>(m_device, m_descriptorSet, simpleStages);
-
     auto moduleTerrainFrag = CreateShaderModule(LOAD_VULKAN_SPV(Terrain_frag));
     auto moduleTerrainVert = CreateShaderModule(LOAD_VULKAN_SPV(Terrain_vert));
     auto stageTerrainFrag =
@@ -45,8 +65,14 @@ VulkanRenderer::VulkanRenderer(std::shared_ptr<Window> window) :
         FillShaderStageCreateInfo(moduleTerrainVert, VK_SHADER_STAGE_VERTEX_BIT);
     std::vector terrainStages {stageTerrainFrag, stageTerrainVert};
 
-    m_terrainPipeline =
-        std::make_shared<VulkanPipeline<Vertex_P_N_C>>(m_device, m_descriptorSet, terrainStages);
+    auto moduleTerrainIndirectVert = CreateShaderModule(LOAD_VULKAN_SPV(TerrainIndirect_vert));
+    auto stageTerrainIndirectVert =
+        FillShaderStageCreateInfo(moduleTerrainIndirectVert, VK_SHADER_STAGE_VERTEX_BIT);
+    std::vector terrainIndirectStages {stageTerrainFrag, stageTerrainIndirectVert};
+
+    auto moduleLitVert = CreateShaderModule(LOAD_VULKAN_SPV(Lit_vert));
+    auto stageLitVert  = FillShaderStageCreateInfo(moduleLitVert, VK_SHADER_STAGE_VERTEX_BIT);
+    std::vector litStages {stageTerrainFrag, stageLitVert};
 
     auto moduleFullscreenFrag = CreateShaderModule(LOAD_VULKAN_SPV(Fullscreen_frag));
     auto moduleFullscreenVert = CreateShaderModule(LOAD_VULKAN_SPV(Fullscreen_vert));
@@ -56,22 +82,114 @@ VulkanRenderer::VulkanRenderer(std::shared_ptr<Window> window) :
         FillShaderStageCreateInfo(moduleFullscreenVert, VK_SHADER_STAGE_VERTEX_BIT);
     std::vector fullscreenStages {stageFullscreenFrag, stageFullscreenVert};
 
-    m_fullscreenPipeline = std::make_shared<VulkanPipeline<VertexEmpty>>(
-        m_device,
-        m_descriptorSet,
-        fullscreenStages,
-        false,
-        false
-    );
-
     auto moduleSkyFrag = CreateShaderModule(LOAD_VULKAN_SPV(Sky_frag));
     auto moduleSkyVert = CreateShaderModule(LOAD_VULKAN_SPV(Sky_vert));
     auto stageSkyFrag  = FillShaderStageCreateInfo(moduleSkyFrag, VK_SHADER_STAGE_FRAGMENT_BIT);
     auto stageSkyVert  = FillShaderStageCreateInfo(moduleSkyVert, VK_SHADER_STAGE_VERTEX_BIT);
     std::vector skyStages {stageSkyFrag, stageSkyVert};
 
-    m_skyPipeline =
-        std::make_shared<VulkanPipeline<Vertex_P>>(m_device, m_descriptorSet, skyStages);
+    auto moduleTerrainGen = CreateShaderModule(LOAD_VULKAN_SPV(TerrainGen_comp));
+    auto stageTerrainGen =
+        FillShaderStageCreateInfo(moduleTerrainGen, VK_SHADER_STAGE_COMPUTE_BIT);
+
+    // Each job only assigns its own member. The first failure is rethrown here.
+    JobCounter         pipelineJobs;
+    std::mutex         pipelineErrorMutex;
+    std::exception_ptr pipelineError;
+
+    const auto createPipeline = [&](std::function<void()> create) {
+        jobSystem->Schedule(
+            [&, create = std::move(create)]() {
+                try
+                {
+                    create();
+                }
+                catch (...)
+                {
+                    std::scoped_lock lock {pipelineErrorMutex};
+                    if (!pipelineError)
+                    {
+                        pipelineError = std::current_exception();
+                    }
+                }
+            },
+            &pipelineJobs
+        );
+    };
+
+    createPipeline([this, simpleStages]() {
+        m_testPipeline =
+            std::make_shared<VulkanPipeline<Vertex_P_C>>(m_device, m_descriptorSet, simpleStages);
+    });
+
+    createPipeline([this, terrainStages]() {
+        m_terrainPipeline = std::make_shared<VulkanPipeline<Vertex_Terrain>>(
+            m_device,
+            m_descriptorSet,
+            terrainStages,
+            true,
+            true,
+            sizeof(TerrainPushConstants)
+        );
+    });
+
+    createPipeline([this, terrainIndirectStages]() {
+        m_terrainIndirectPipeline = std::make_shared<VulkanPipeline<Vertex_Terrain>>(
+            m_device,
+            m_descriptorSet,
+            terrainIndirectStages,
+            true,
+            true,
+            sizeof(TerrainIndirectPushConstants)
+        );
+    });
+
+    createPipeline([this, litStages]() {
+        m_litPipeline =
+            std::make_shared<VulkanPipeline<Vertex_P_N_C>>(m_device, m_descriptorSet, litStages);
+    });
+
+    createPipeline([this, fullscreenStages]() {
+        m_fullscreenPipeline = std::make_shared<VulkanPipeline<VertexEmpty>>(
+            m_device,
+            m_descriptorSet,
+            fullscreenStages,
+            false,
+            false
+        );
+    });
+
+    createPipeline([this, skyStages]() {
+        m_skyPipeline =
+            std::make_shared<VulkanPipeline<Vertex_P>>(m_device, m_descriptorSet, skyStages);
+    });
+
+    // Binding 0 is the noise permutation, 1 the vertex output.
+    createPipeline([this, stageTerrainGen]() {
+        m_terrainGenPipeline = std::make_unique<VulkanComputePipeline>(
+            m_device,
+            stageTerrainGen,
+            2,
+            sizeof(TerrainGenPushConstants)
+        );
+    });
+
+    jobSystem->Wait(pipelineJobs);
+    if (pipelineError)
+    {
+        std::rethrow_exception(pipelineError);
+    }
+
+    if (m_device.SupportsIndirectDraw())
+    {
+        CreateTerrainCull();
+    }
+
+    LOG_INFO(
+        "Created pipelines in {:.1f} ms, {} pipeline cache",
+        (Time::Now() - pipelineStart) * 1000.0,
+        m_device.IsPipelineCacheWarm() ? "warm" : "cold"
+    );
 }
 
 VulkanRenderer::~VulkanRenderer()
@@ -82,8 +200,14 @@ VulkanRenderer::~VulkanRenderer()
 
     m_testPipeline.reset();
     m_terrainPipeline.reset();
+    m_terrainIndirectPipeline.reset();
+    m_litPipeline.reset();
     m_fullscreenPipeline.reset();
     m_skyPipeline.reset();
+    m_terrainGenPipeline.reset();
+    m_terrainCullPipeline.reset();
+    m_terrainPermutation.reset();
+    m_uploader.reset();
 
     m_descriptorSet.reset();
 
@@ -92,7 +216,389 @@ VulkanRenderer::~VulkanRenderer()
         vkDestroyShaderModule(m_device.GetVkDevice(), module, nullptr);
     }
 
-    m_frameBuffers.clear();
+    m_frameResources.clear();
+    m_inFlightResources.clear();
+    m_mappedSlotBuffers.clear();
+    m_gridIndexBuffers.clear();
+    m_terrainDraws.reset();
+    m_terrainCommands.reset();
+    m_terrainDrawCounts.reset();
+}
+
+bool VulkanRenderer::SetTerrainPermutation(std::span<const int32_t> permutation)
+{
+    std::vector<int32_t> data(permutation.begin(), permutation.end());
+    CreateBuffer(
+        m_terrainPermutation,
+        StorageBuffer,
+        data.data(),
+        sizeof(int32_t),
+        static_cast<uint32_t>(data.size())
+    );
+
+    auto buffer = static_pointer_cast<VulkanBuffer>(m_terrainPermutation);
+    m_terrainGenPipeline->SetStorageBuffer(0, buffer->GetVkBuffer());
+    return true;
+}
+
+bool VulkanRenderer::CreateMappedBuffer(
+    std::shared_ptr<Buffer>& buffer,
+    BufferType               bufferType,
+    uint32_t                 elementSize,
+    uint32_t                 elementCount,
+    void**                   data
+)
+{
+    auto mappedBuffer =
+        std::make_shared<VulkanBuffer>(bufferType, Mapped, elementSize, elementCount);
+    if (mappedBuffer->GetMappedData() == nullptr)
+    {
+        return false;
+    }
+
+    *data  = mappedBuffer->GetMappedData();
+    buffer = static_pointer_cast<Buffer>(mappedBuffer);
+    return true;
+}
+
+void VulkanRenderer::SubmitMappedBuffer(
+    std::shared_ptr<Buffer>&       buffer,
+    const std::shared_ptr<Buffer>& mappedBuffer
+)
+{
+    auto vkMappedBuffer = static_pointer_cast<VulkanBuffer>(mappedBuffer);
+    vkMappedBuffer->Flush();
+
+    if (!m_loggedMappedMemory)
+    {
+        LOG_INFO(
+            "Mapped buffers are in {} memory",
+            vkMappedBuffer->IsDeviceLocal() ? "device-local" : "staging"
+        );
+        m_loggedMappedMemory = true;
+    }
+
+    // ReBAR/UMA, the GPU reads what the CPU wrote.
+    if (vkMappedBuffer->IsDeviceLocal())
+    {
+        buffer = mappedBuffer;
+        return;
+    }
+
+    auto deviceBuffer = std::make_shared<VulkanBuffer>(
+        mappedBuffer->GetType(),
+        Device,
+        static_cast<uint32_t>(mappedBuffer->GetElementSize()),
+        mappedBuffer->GetElementCount()
+    );
+    m_uploader->Copy(vkMappedBuffer, deviceBuffer);
+    buffer = static_pointer_cast<Buffer>(deviceBuffer);
+}
+
+bool VulkanRenderer::CreateSlotBuffer(
+    std::shared_ptr<Buffer>& buffer,
+    BufferType               bufferType,
+    uint32_t                 elementSize,
+    uint32_t                 elementCount,
+    void**                   data
+)
+{
+    // Written in place with ReBAR/UMA, through uploads otherwise.
+    auto mappedBuffer =
+        std::make_shared<VulkanBuffer>(bufferType, Mapped, elementSize, elementCount);
+    if (mappedBuffer->GetMappedData() != nullptr && mappedBuffer->IsDeviceLocal())
+    {
+        *data  = mappedBuffer->GetMappedData();
+        buffer = static_pointer_cast<Buffer>(mappedBuffer);
+        m_mappedSlotBuffers.push_back(mappedBuffer);
+        return true;
+    }
+    mappedBuffer.reset();
+
+    *data  = nullptr;
+    buffer = std::make_shared<VulkanBuffer>(bufferType, Device, elementSize, elementCount);
+    return true;
+}
+
+void VulkanRenderer::WriteBuffer(
+    const std::shared_ptr<Buffer>& buffer,
+    uint32_t                       firstElement,
+    const void*                    data,
+    uint32_t                       elementCount
+)
+{
+    const VkDeviceSize elementSize = buffer->GetElementSize();
+    m_uploader->Upload(
+        data,
+        elementCount * elementSize,
+        static_pointer_cast<VulkanBuffer>(buffer),
+        firstElement * elementSize
+    );
+}
+
+void VulkanRenderer::CopyBuffer(
+    const std::shared_ptr<Buffer>& mappedBuffer,
+    const std::shared_ptr<Buffer>& buffer,
+    uint32_t                       firstElement
+)
+{
+    auto vkMappedBuffer = static_pointer_cast<VulkanBuffer>(mappedBuffer);
+    vkMappedBuffer->Flush();
+
+    m_uploader->Copy(
+        vkMappedBuffer,
+        static_pointer_cast<VulkanBuffer>(buffer),
+        firstElement * buffer->GetElementSize()
+    );
+}
+
+void VulkanRenderer::CreateTerrainCull()
+{
+    // Each frame in flight has its own range of draws, commands and a count.
+    const uint32_t drawCount = TERRAIN_MAX_DRAWS * MAX_FRAMES_IN_FLIGHT;
+
+    auto draws =
+        std::make_shared<VulkanBuffer>(StorageBuffer, Mapped, sizeof(TerrainDraw), drawCount);
+    if (draws->GetMappedData() == nullptr)
+    {
+        LOG_WARNING("Failed to map terrain draws, culling terrain on the CPU");
+        return;
+    }
+
+    m_terrainDraws    = draws;
+    m_terrainCommands = std::make_shared<VulkanBuffer>(
+        IndirectBuffer,
+        Device,
+        sizeof(VkDrawIndexedIndirectCommand),
+        drawCount
+    );
+    m_terrainDrawCounts = std::make_shared<VulkanBuffer>(
+        IndirectBuffer,
+        Device,
+        sizeof(uint32_t),
+        MAX_FRAMES_IN_FLIGHT
+    );
+
+    auto moduleTerrainCull = CreateShaderModule(LOAD_VULKAN_SPV(TerrainCull_comp));
+    auto stageTerrainCull =
+        FillShaderStageCreateInfo(moduleTerrainCull, VK_SHADER_STAGE_COMPUTE_BIT);
+
+    // Binding 0 is the draws, 1 the commands, 2 the visible counts.
+    m_terrainCullPipeline = std::make_unique<VulkanComputePipeline>(
+        m_device,
+        stageTerrainCull,
+        3,
+        sizeof(TerrainCullPushConstants)
+    );
+    m_terrainCullPipeline->SetStorageBuffer(0, m_terrainDraws->GetVkBuffer());
+    m_terrainCullPipeline->SetStorageBuffer(1, m_terrainCommands->GetVkBuffer());
+    m_terrainCullPipeline->SetStorageBuffer(2, m_terrainDrawCounts->GetVkBuffer());
+
+    // Read by TerrainIndirect.vert.
+    m_descriptorSet->SetStorageBuffer(m_terrainDraws);
+
+    LOG_INFO("Culling terrain on the GPU, up to {} draws per frame", TERRAIN_MAX_DRAWS);
+}
+
+bool VulkanRenderer::AddTerrainDraw(const TerrainDraw& draw)
+{
+    if (m_terrainCullPipeline == nullptr || m_terrainDrawCount >= TERRAIN_MAX_DRAWS)
+    {
+        return false;
+    }
+
+    const uint32_t firstDraw = m_device.GetCurrentFrame() * TERRAIN_MAX_DRAWS;
+    auto*          draws     = static_cast<TerrainDraw*>(m_terrainDraws->GetMappedData());
+    draws[firstDraw + m_terrainDrawCount] = draw;
+    m_terrainDrawCount++;
+    return true;
+}
+
+void VulkanRenderer::DrawTerrain(
+    const std::shared_ptr<Buffer>&  vertexBuffer,
+    const std::shared_ptr<Buffer>&  indexBuffer,
+    const std::array<glm::vec4, 6>& planes
+)
+{
+    if (m_terrainDrawCount == 0)
+    {
+        return;
+    }
+
+    const uint32_t frame     = m_device.GetCurrentFrame();
+    const uint32_t firstDraw = frame * TERRAIN_MAX_DRAWS;
+
+    const VkDeviceSize commandSize = sizeof(VkDrawIndexedIndirectCommand);
+    const VkDeviceSize countOffset = frame * sizeof(uint32_t);
+    auto               counts      = m_terrainDrawCounts->GetVkBuffer();
+
+    // Can't dispatch while rendering, culled in the frame's compute command buffer.
+    auto computeBuffer = m_device.GetComputeCommandBuffer();
+
+    vkCmdFillBuffer(computeBuffer, counts, countOffset, sizeof(uint32_t), 0);
+
+    VkMemoryBarrier clearBarrier {};
+    clearBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(
+        computeBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1,
+        &clearBarrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    TerrainCullPushConstants constants {};
+    std::copy(planes.begin(), planes.end(), constants.planes);
+    constants.firstDraw  = firstDraw;
+    constants.drawCount  = m_terrainDrawCount;
+    constants.indexCount = indexBuffer->GetElementCount();
+    constants.countIndex = frame;
+
+    m_terrainCullPipeline->Bind(computeBuffer);
+    vkCmdPushConstants(
+        computeBuffer,
+        m_terrainCullPipeline->GetVkPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0,
+        sizeof(constants),
+        &constants
+    );
+
+    const uint32_t groupSize  = TERRAIN_CULL_GROUP_SIZE;
+    const uint32_t groupCount = (m_terrainDrawCount + groupSize - 1) / groupSize;
+    vkCmdDispatch(computeBuffer, groupCount, 1, 1);
+
+    // Submitted ahead of the frame's command buffer, this covers the draw below.
+    VkMemoryBarrier cullBarrier {};
+    cullBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+    vkCmdPipelineBarrier(
+        computeBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0,
+        1,
+        &cullBarrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    BindBuffers(vertexBuffer, indexBuffer);
+    vkCmdDrawIndexedIndirectCount(
+        m_device.GetCommandBuffer(),
+        m_terrainCommands->GetVkBuffer(),
+        firstDraw * commandSize,
+        counts,
+        countOffset,
+        m_terrainDrawCount,
+        static_cast<uint32_t>(commandSize)
+    );
+}
+
+bool VulkanRenderer::GenerateTerrain(
+    std::shared_ptr<Buffer>&       buffer,
+    const TerrainGenPushConstants& params
+)
+{
+    if (m_terrainPermutation == nullptr)
+    {
+        return false;
+    }
+
+    const uint32_t vertexCount = params.VertexCount();
+
+    // Written in place, no host copy or staging.
+    auto deviceBuffer =
+        std::make_shared<VulkanBuffer>(VertexBuffer, Device, sizeof(Vertex_Terrain), vertexCount);
+    DispatchTerrainGen(
+        deviceBuffer,
+        params,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+    );
+
+    buffer = static_pointer_cast<Buffer>(deviceBuffer);
+    return true;
+}
+
+bool VulkanRenderer::ReadTerrain(
+    const TerrainGenPushConstants& params,
+    std::vector<Vertex_Terrain>&   vertices
+)
+{
+    if (m_terrainPermutation == nullptr)
+    {
+        return false;
+    }
+
+    const uint32_t vertexCount = params.VertexCount();
+
+    auto hostBuffer =
+        std::make_shared<VulkanBuffer>(StorageBuffer, Host, sizeof(Vertex_Terrain), vertexCount);
+    DispatchTerrainGen(hostBuffer, params, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+
+    vertices.resize(vertexCount);
+    hostBuffer->Read(vertices.data(), vertexCount * sizeof(Vertex_Terrain));
+    return true;
+}
+
+void VulkanRenderer::DispatchTerrainGen(
+    std::shared_ptr<VulkanBuffer>  target,
+    const TerrainGenPushConstants& params,
+    VkPipelineStageFlags           dstStage,
+    VkAccessFlags                  dstAccess
+)
+{
+    const uint32_t groupSize  = TERRAIN_GEN_GROUP_SIZE;
+    const uint32_t groupCount = (target->GetElementCount() + groupSize - 1) / groupSize;
+
+    // Previous dispatch was waited on, safe to rebind.
+    m_terrainGenPipeline->SetStorageBuffer(1, target->GetVkBuffer());
+
+    auto commandBuffer = GetTemporaryCommandBuffer();
+
+    m_terrainGenPipeline->Bind(commandBuffer);
+    vkCmdPushConstants(
+        commandBuffer,
+        m_terrainGenPipeline->GetVkPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0,
+        sizeof(params),
+        &params
+    );
+    vkCmdDispatch(commandBuffer, groupCount, 1, 1);
+
+    VkMemoryBarrier barrier {};
+    barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = dstAccess;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        dstStage,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    SubmitTemporaryCommandBuffer(commandBuffer);
 }
 
 void VulkanRenderer::SetWindow(std::shared_ptr<Window> window)
@@ -123,20 +629,48 @@ float VulkanRenderer::GetAspect()
 void VulkanRenderer::Begin()
 {
     m_device.Begin();
+
+    // Begin waited for the fence of the last submit in this frame slot,
+    // the GPU is done with the buffers it drew.
+    m_inFlightResources[m_device.GetCurrentFrame()].clear();
+
+    // A new command buffer has nothing bound.
+    m_boundPipeline.reset();
+    m_boundVertexBuffer = nullptr;
+    m_boundIndexBuffer  = nullptr;
+
+    // This frame slot's draws were consumed by the submit Begin waited for.
+    m_terrainDrawCount = 0;
 }
 
 void VulkanRenderer::Submit()
 {
+    // One transfer submit for everything uploaded this frame.
+    m_uploader->Flush();
+    for (const auto& buffer : m_mappedSlotBuffers)
+    {
+        buffer->Flush();
+    }
+    if (m_terrainDrawCount > 0)
+    {
+        m_terrainDraws->Flush();
+    }
     m_device.Submit();
 
-    // Not ideal but guarantees chunk buffers aren't freed too early.
-    m_device.WaitForGraphicsIdle();
-    m_frameBuffers.clear();
+    // Kept until the frame's fence has signaled, see Begin.
+    std::swap(m_inFlightResources[m_device.GetCurrentFrame()], m_frameResources);
+    m_frameResources.clear();
 }
 
 void VulkanRenderer::Present()
 {
     m_device.Present();
+
+    if (!m_presentedFrame)
+    {
+        LOG_INFO("Presented the first frame {:.1f} ms after startup", Time::Uptime() * 1000.0);
+        m_presentedFrame = true;
+    }
 }
 
 void VulkanRenderer::UpdateUniforms(const std::shared_ptr<Camera> camera)
@@ -170,7 +704,7 @@ void VulkanRenderer::GetImGuiInfo(VulkanImGuiCreationInfo& info)
     info.imGuiInfo.Device                      = m_device.GetVkDevice();
     info.imGuiInfo.QueueFamily                 = m_device.GetGraphicsQueueIndex();
     info.imGuiInfo.Queue                       = m_device.GetGraphicsQueue();
-    info.imGuiInfo.PipelineCache               = VK_NULL_HANDLE; // TODO
+    info.imGuiInfo.PipelineCache               = m_device.GetVkPipelineCache();
     info.imGuiInfo.DescriptorPool              = m_device.GetImGuiDescriptorPool();
     info.imGuiInfo.UseDynamicRendering         = true;
     info.imGuiInfo.PipelineRenderingCreateInfo = info.pipelineCreateInfo;
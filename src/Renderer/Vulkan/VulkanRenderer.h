@@ -1,24 +1,29 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <stdexcept>
 
 #include <imgui_impl_vulkan.h>
 
+#include "../../Jobs/JobSystem.h"
 #include "../Renderer.h"
 #include "VulkanBuffer.h"
 #include "VulkanCommon.h"
+#include "VulkanComputePipeline.h"
 #include "VulkanDescriptorSet.h"
 #include "VulkanDevice.h"
 #include "VulkanInstance.h"
 #include "VulkanPipeline.h"
+#include "VulkanUploader.h"
 
 namespace drive
 {
 class VulkanRenderer final : public Renderer
 {
   public:
-    VulkanRenderer(std::shared_ptr<Window> window);
+    // Pipelines are compiled on jobSystem workers.
+    VulkanRenderer(std::shared_ptr<Window> window, std::shared_ptr<JobSystem> jobSystem);
     ~VulkanRenderer();
 
     VulkanRenderer(const VulkanRenderer&)            = delete;
@@ -69,8 +74,10 @@ class VulkanRenderer final : public Renderer
         return m_device.GetTemporaryCommandBuffer();
     }
 
+    // Pending uploads are submitted first, the command buffer may read them.
     void SubmitTemporaryCommandBuffer(VkCommandBuffer buffer)
     {
+        m_uploader->Flush();
         m_device.SubmitTemporaryCommandBuffer(buffer);
     }
 
@@ -82,19 +89,20 @@ class VulkanRenderer final : public Renderer
         uint32_t                 elementCount
     ) override
     {
-        auto hostBuffer =
-            std::make_shared<VulkanBuffer>(bufferType, Host, elementSize, elementCount);
         auto deviceBuffer =
             std::make_shared<VulkanBuffer>(bufferType, Device, elementSize, elementCount);
-        hostBuffer->Write(data, elementSize * elementCount);
-        auto tempBuffer = GetTemporaryCommandBuffer();
-        hostBuffer->CopyToDevice(tempBuffer, static_pointer_cast<Buffer>(deviceBuffer));
-        SubmitTemporaryCommandBuffer(tempBuffer);
+        m_uploader->Upload(data, elementSize * elementCount, deviceBuffer);
         buffer = static_pointer_cast<Buffer>(deviceBuffer);
     }
 
     void BindPipeline(RenderPipeline pipe) override
     {
+        if (pipe == m_boundPipeline)
+        {
+            return;
+        }
+        m_boundPipeline = pipe;
+
         auto commandBuffer = m_device.GetCommandBuffer();
         auto currentFrame  = m_device.GetCurrentFrame();
 
@@ -103,6 +111,7 @@ class VulkanRenderer final : public Renderer
             case TEST:
             {
                 m_testPipeline->Bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, currentFrame);
+                m_boundPipelineLayout = m_testPipeline->GetVkPipelineLayout();
                 break;
             }
 
@@ -110,6 +119,22 @@ class VulkanRenderer final : public Renderer
             {
                 m_terrainPipeline
                     ->Bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, currentFrame);
+                m_boundPipelineLayout = m_terrainPipeline->GetVkPipelineLayout();
+                break;
+            }
+
+            case TERRAIN_INDIRECT:
+            {
+                m_terrainIndirectPipeline
+                    ->Bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, currentFrame);
+                m_boundPipelineLayout = m_terrainIndirectPipeline->GetVkPipelineLayout();
+                break;
+            }
+
+            case LIT:
+            {
+                m_litPipeline->Bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, currentFrame);
+                m_boundPipelineLayout = m_litPipeline->GetVkPipelineLayout();
                 break;
             }
 
@@ -117,12 +142,14 @@ class VulkanRenderer final : public Renderer
             {
                 m_fullscreenPipeline
                     ->Bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, currentFrame);
+                m_boundPipelineLayout = m_fullscreenPipeline->GetVkPipelineLayout();
                 break;
             }
 
             case SKY:
             {
                 m_skyPipeline->Bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, currentFrame);
+                m_boundPipelineLayout = m_skyPipeline->GetVkPipelineLayout();
                 break;
             }
 
@@ -133,7 +160,79 @@ class VulkanRenderer final : public Renderer
         }
     }
 
+    void PushConstants(const void* data, uint32_t size) override
+    {
+        vkCmdPushConstants(
+            m_device.GetCommandBuffer(),
+            m_boundPipelineLayout,
+            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+            0,
+            size,
+            data
+        );
+    }
+
+    bool CreateMappedBuffer(
+        std::shared_ptr<Buffer>& buffer,
+        BufferType               bufferType,
+        uint32_t                 elementSize,
+        uint32_t                 elementCount,
+        void**                   data
+    ) override;
+    void SubmitMappedBuffer(
+        std::shared_ptr<Buffer>&       buffer,
+        const std::shared_ptr<Buffer>& mappedBuffer
+    ) override;
+
+    bool CreateSlotBuffer(
+        std::shared_ptr<Buffer>& buffer,
+        BufferType               bufferType,
+        uint32_t                 elementSize,
+        uint32_t                 elementCount,
+        void**                   data
+    ) override;
+    void WriteBuffer(
+        const std::shared_ptr<Buffer>& buffer,
+        uint32_t                       firstElement,
+        const void*                    data,
+        uint32_t                       elementCount
+    ) override;
+    void CopyBuffer(
+        const std::shared_ptr<Buffer>& mappedBuffer,
+        const std::shared_ptr<Buffer>& buffer,
+        uint32_t                       firstElement
+    ) override;
+
+    bool AddTerrainDraw(const TerrainDraw& draw) override;
+    void DrawTerrain(
+        const std::shared_ptr<Buffer>&  vertexBuffer,
+        const std::shared_ptr<Buffer>&  indexBuffer,
+        const std::array<glm::vec4, 6>& planes
+    ) override;
+
+    bool SetTerrainPermutation(std::span<const int32_t> permutation) override;
+    bool GenerateTerrain(
+        std::shared_ptr<Buffer>&       buffer,
+        const TerrainGenPushConstants& params
+    ) override;
+    bool ReadTerrain(
+        const TerrainGenPushConstants& params,
+        std::vector<Vertex_Terrain>&   vertices
+    ) override;
+
   private:
+    // TerrainCull.comp and its buffers, only with VulkanDevice::SupportsIndirectDraw.
+    void CreateTerrainCull();
+
+    // Runs TerrainGen.comp into target and waits for it,
+    // the barrier makes the writes visible to dstStage/dstAccess.
+    void DispatchTerrainGen(
+        std::shared_ptr<VulkanBuffer>  target,
+        const TerrainGenPushConstants& params,
+        VkPipelineStageFlags           dstStage,
+        VkAccessFlags                  dstAccess
+    );
+
     VkShaderModule& CreateShaderModule(VkShaderModuleCreateInfo createInfo);
     constexpr VkPipelineShaderStageCreateInfo FillShaderStageCreateInfo(
         VkShaderModule&       module,
@@ -143,12 +242,44 @@ class VulkanRenderer final : public Renderer
     VulkanInstance m_instance;
     VulkanDevice   m_device;
 
+    std::unique_ptr<VulkanUploader> m_uploader;
+
     std::shared_ptr<VulkanDescriptorSet> m_descriptorSet;
     std::vector<VkShaderModule>          m_vkShaderModules;
 
-    std::shared_ptr<VulkanPipeline<Vertex_P_C>>   m_testPipeline;
-    std::shared_ptr<VulkanPipeline<Vertex_P_N_C>> m_terrainPipeline;
-    std::shared_ptr<VulkanPipeline<VertexEmpty>>  m_fullscreenPipeline;
-    std::shared_ptr<VulkanPipeline<Vertex_P>>     m_skyPipeline;
+    std::shared_ptr<VulkanPipeline<Vertex_P_C>>     m_testPipeline;
+    std::shared_ptr<VulkanPipeline<Vertex_Terrain>> m_terrainPipeline;
+    std::shared_ptr<VulkanPipeline<Vertex_Terrain>> m_terrainIndirectPipeline;
+    std::shared_ptr<VulkanPipeline<Vertex_P_N_C>>   m_litPipeline;
+    std::shared_ptr<VulkanPipeline<VertexEmpty>>    m_fullscreenPipeline;
+    std::shared_ptr<VulkanPipeline<Vertex_P>>       m_skyPipeline;
+
+    std::unique_ptr<VulkanComputePipeline> m_terrainGenPipeline;
+    std::shared_ptr<Buffer>                m_terrainPermutation;
+
+    // Null without GPU culling. Draws are written by the CPU, commands and
+    // counts by TerrainCull.comp, in a range per frame in flight.
+    std::unique_ptr<VulkanComputePipeline> m_terrainCullPipeline;
+    std::shared_ptr<VulkanBuffer>          m_terrainDraws;
+    std::shared_ptr<VulkanBuffer>          m_terrainCommands;
+    std::shared_ptr<VulkanBuffer>          m_terrainDrawCounts;
+    uint32_t                               m_terrainDrawCount = 0; // Queued this frame
+
+    // Bound by BindPipeline, reset every frame. ImGui binds its own after everything else.
+    std::optional<RenderPipeline> m_boundPipeline;
+    VkPipelineLayout              m_boundPipelineLayout = VK_NULL_HANDLE;
+
+    // m_frameResources of each frame in flight, indexed by frame.
+    // Released once Begin has waited for that frame's fence.
+    std::vector<std::vector<std::shared_ptr<void>>> m_inFlightResources;
+
+    // Slot buffers written in place by the CPU, flushed before every submit.
+    std::vector<std::shared_ptr<VulkanBuffer>> m_mappedSlotBuffers;
+
+    // Whether mapped buffers were device-local, logged on the first submit.
+    bool m_loggedMappedMemory = false;
+
+    // Startup time until the first present is logged once.
+    bool m_presentedFrame = false;
 };
 } // namespace drive
@@ -0,0 +1,103 @@
+#include <stdexcept>
+
+#include "VulkanCommon.h"
+#include "VulkanStagingRing.h"
+
+namespace drive
+{
+
+#define STAGING_ALIGNMENT 16
+
+VulkanStagingRing::VulkanStagingRing(VkDeviceSize size) :
+    m_size(size)
+{
+    VkBufferCreateInfo bufferInfo {};
+    bufferInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size        = m_size;
+    bufferInfo.usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    // Host memory even with ReBAR, the copy is what moves it to VRAM.
+    VmaAllocationCreateInfo allocInfo {};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+    allocInfo.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+    allocInfo.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocationInfo {};
+    VK_CHECK(
+        vmaCreateBuffer(
+            g_vma,
+            &bufferInfo,
+            &allocInfo,
+            &m_vkBuffer,
+            &m_vmaAllocation,
+            &allocationInfo
+        ),
+        "Failed to create staging ring"
+    );
+
+    m_mappedData = static_cast<uint8_t*>(allocationInfo.pMappedData);
+}
+
+VulkanStagingRing::~VulkanStagingRing()
+{
+    vmaDestroyBuffer(g_vma, m_vkBuffer, m_vmaAllocation);
+}
+
+std::optional<VkDeviceSize> VulkanStagingRing::Allocate(VkDeviceSize size)
+{
+    const bool empty = m_submits.empty() && !m_open;
+    if (empty)
+    {
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    VkDeviceSize offset = (m_head + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+
+    // Free from head to the end and from the start to tail.
+    if (empty || m_tail < m_head)
+    {
+        if (offset + size > m_size)
+        {
+            if (size > m_tail)
+            {
+                return std::nullopt;
+            }
+            offset = 0;
+        }
+    }
+    // Free from head to tail.
+    else if (offset + size > m_tail)
+    {
+        return std::nullopt;
+    }
+
+    m_head = offset + size;
+    m_open = true;
+    return offset;
+}
+
+void VulkanStagingRing::Close(uint64_t value)
+{
+    if (!m_open)
+    {
+        return;
+    }
+
+    // Ignored by VMA for coherent memory.
+    vmaFlushAllocation(g_vma, m_vmaAllocation, 0, VK_WHOLE_SIZE);
+
+    m_submits.push_back({.value = value, .end = m_head});
+    m_open = false;
+}
+
+void VulkanStagingRing::Reclaim(uint64_t completed)
+{
+    while (!m_submits.empty() && m_submits.front().value <= completed)
+    {
+        m_tail = m_submits.front().end;
+        m_submits.pop_front();
+    }
+}
+} // namespace drive
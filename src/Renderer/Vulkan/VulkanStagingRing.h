@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+#include "VmaUsage.h"
+
+namespace drive
+{
+// Persistently mapped staging memory, allocated front to back and wrapping around.
+// Allocations between two Close calls belong to one submit and are freed together
+// once Reclaim sees its timeline value complete. Render thread only.
+class VulkanStagingRing
+{
+  public:
+    VulkanStagingRing() = delete;
+    VulkanStagingRing(VkDeviceSize size);
+    ~VulkanStagingRing();
+
+    VulkanStagingRing(const VulkanStagingRing&)            = delete;
+    VulkanStagingRing(VulkanStagingRing&&)                 = delete;
+    VulkanStagingRing& operator=(const VulkanStagingRing&) = delete;
+    VulkanStagingRing& operator=(VulkanStagingRing&&)      = delete;
+
+    // Offset of size bytes to write at GetMappedData() + offset,
+    // nullopt if they don't fit until earlier submits complete.
+    std::optional<VkDeviceSize> Allocate(VkDeviceSize size);
+
+    // Makes the writes visible and assigns everything allocated since the
+    // last Close to the submit signaling value.
+    void Close(uint64_t value);
+
+    // Frees the allocations of submits up to the completed value.
+    void Reclaim(uint64_t completed);
+
+    uint8_t* GetMappedData() const
+    {
+        return m_mappedData;
+    }
+
+    VkBuffer GetVkBuffer() const
+    {
+        return m_vkBuffer;
+    }
+
+    VkDeviceSize GetSize() const
+    {
+        return m_size;
+    }
+
+  private:
+    struct Submit
+    {
+        uint64_t     value;
+        VkDeviceSize end;
+    };
+
+    VkBuffer      m_vkBuffer;
+    VmaAllocation m_vmaAllocation;
+    uint8_t*      m_mappedData = nullptr;
+    VkDeviceSize  m_size;
+
+    // In use from tail to head, wrapping at m_size. head == tail is empty
+    // or full, told apart by whether anything is allocated.
+    VkDeviceSize       m_head = 0;
+    VkDeviceSize       m_tail = 0;
+    bool               m_open = false;
+    std::deque<Submit> m_submits;
+};
+} // namespace drive
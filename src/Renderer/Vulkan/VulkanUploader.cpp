@@ -0,0 +1,229 @@
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "../../Log.h"
+#include "VulkanCommon.h"
+#include "VulkanUploader.h"
+
+namespace drive
+{
+VulkanUploader::VulkanUploader(VulkanDevice& device, VkDeviceSize stagingSize) :
+    m_device(device),
+    m_staging(stagingSize)
+{
+    LOG_INFO("Creating VulkanUploader");
+
+    VkCommandPoolCreateInfo poolInfo {};
+    poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = m_device.GetTransferQueueIndex();
+
+    VK_CHECK(
+        vkCreateCommandPool(m_device.GetVkDevice(), &poolInfo, nullptr, &m_vkCommandPool),
+        "Failed to create upload command pool"
+    );
+
+    VkSemaphoreTypeCreateInfo typeInfo {};
+    typeInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue  = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    VK_CHECK(
+        vkCreateSemaphore(m_device.GetVkDevice(), &semaphoreInfo, nullptr, &m_vkTimeline),
+        "Failed to create upload timeline semaphore"
+    );
+}
+
+VulkanUploader::~VulkanUploader()
+{
+    LOG_INFO("Destroying VulkanUploader");
+
+    // Command buffers are freed with the pool.
+    vkDestroySemaphore(m_device.GetVkDevice(), m_vkTimeline, nullptr);
+    vkDestroyCommandPool(m_device.GetVkDevice(), m_vkCommandPool, nullptr);
+}
+
+void VulkanUploader::Upload(
+    const void*                   data,
+    VkDeviceSize                  size,
+    std::shared_ptr<VulkanBuffer> destination,
+    VkDeviceSize                  offset
+)
+{
+    const auto stagingOffset = m_staging.Allocate(size);
+    if (!stagingOffset.has_value())
+    {
+        LOG_DEBUG(
+            "{} KB upload doesn't fit the {} KB staging ring",
+            size / 1024,
+            m_staging.GetSize() / 1024
+        );
+
+        const auto elementSize = static_cast<uint32_t>(destination->GetElementSize());
+        auto       hostBuffer  = std::make_shared<VulkanBuffer>(
+            destination->GetType(),
+            Host,
+            elementSize,
+            static_cast<uint32_t>(size / elementSize)
+        );
+        hostBuffer->Write(const_cast<void*>(data), size);
+        Copy(hostBuffer, destination, offset);
+        return;
+    }
+
+    std::memcpy(m_staging.GetMappedData() + stagingOffset.value(), data, size);
+    Record(m_staging.GetVkBuffer(), stagingOffset.value(), *destination, offset, size);
+
+    m_recording.buffers.push_back(std::move(destination));
+}
+
+void VulkanUploader::Copy(
+    std::shared_ptr<VulkanBuffer> source,
+    std::shared_ptr<VulkanBuffer> destination,
+    VkDeviceSize                  offset
+)
+{
+    Record(source->GetVkBuffer(), 0, *destination, offset, source->GetSize());
+
+    m_recording.buffers.push_back(std::move(source));
+    m_recording.buffers.push_back(std::move(destination));
+}
+
+void VulkanUploader::Record(
+    VkBuffer            source,
+    VkDeviceSize        sourceOffset,
+    const VulkanBuffer& destination,
+    VkDeviceSize        offset,
+    VkDeviceSize        size
+)
+{
+    if (offset + size > destination.GetSize())
+    {
+        throw std::runtime_error("Tried uploading past the end of a buffer");
+    }
+
+    if (m_recording.commandBuffer == VK_NULL_HANDLE)
+    {
+        Begin();
+    }
+
+    VkBufferCopy copyRegion {};
+    copyRegion.size      = size;
+    copyRegion.srcOffset = sourceOffset;
+    copyRegion.dstOffset = offset;
+
+    vkCmdCopyBuffer(
+        m_recording.commandBuffer,
+        source,
+        destination.GetVkBuffer(),
+        1,
+        &copyRegion
+    );
+}
+
+void VulkanUploader::Flush()
+{
+    Collect();
+
+    if (m_recording.commandBuffer == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    VK_CHECK(
+        vkEndCommandBuffer(m_recording.commandBuffer),
+        "Failed to end upload command buffer"
+    );
+
+    // Staged writes have to be flushed before the submit.
+    m_recording.value = ++m_submitted;
+    m_staging.Close(m_recording.value);
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo {};
+    timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues    = &m_recording.value;
+
+    VkSubmitInfo submitInfo {};
+    submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext                = &timelineInfo;
+    submitInfo.commandBufferCount   = 1;
+    submitInfo.pCommandBuffers      = &m_recording.commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores    = &m_vkTimeline;
+
+    VK_CHECK(
+        vkQueueSubmit(m_device.GetTransferQueue(), 1, &submitInfo, VK_NULL_HANDLE),
+        "Failed to submit uploads"
+    );
+
+    // The semaphore wait also makes the copies visible to the graphics queue.
+    m_device.WaitForTimeline(m_vkTimeline, m_recording.value);
+
+    m_inFlight.push_back(std::move(m_recording));
+    m_recording = {};
+}
+
+void VulkanUploader::Begin()
+{
+    if (m_freeCommandBuffers.empty())
+    {
+        VkCommandBufferAllocateInfo allocInfo {};
+        allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool        = m_vkCommandPool;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer {};
+        VK_CHECK(
+            vkAllocateCommandBuffers(m_device.GetVkDevice(), &allocInfo, &commandBuffer),
+            "Failed to allocate upload command buffer"
+        );
+        m_freeCommandBuffers.push_back(commandBuffer);
+    }
+
+    m_recording.commandBuffer = m_freeCommandBuffers.back();
+    m_freeCommandBuffers.pop_back();
+
+    VK_CHECK(
+        vkResetCommandBuffer(m_recording.commandBuffer, 0),
+        "Failed to reset upload command buffer"
+    );
+
+    VkCommandBufferBeginInfo beginInfo {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VK_CHECK(
+        vkBeginCommandBuffer(m_recording.commandBuffer, &beginInfo),
+        "Failed to begin upload command buffer"
+    );
+}
+
+void VulkanUploader::Collect()
+{
+    if (m_inFlight.empty())
+    {
+        return;
+    }
+
+    uint64_t completed = 0;
+    VK_CHECK(
+        vkGetSemaphoreCounterValue(m_device.GetVkDevice(), m_vkTimeline, &completed),
+        "Failed to get upload timeline value"
+    );
+
+    // Submitted in order, values complete in order.
+    while (!m_inFlight.empty() && m_inFlight.front().value <= completed)
+    {
+        m_freeCommandBuffers.push_back(m_inFlight.front().commandBuffer);
+        m_inFlight.pop_front();
+    }
+    m_staging.Reclaim(completed);
+}
+} // namespace drive
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+#include "VulkanStagingRing.h"
+
+namespace drive
+{
+// Batches buffer copies into one submit on the transfer queue, see
+// VulkanDevice::GetTransferQueue. Submits signal a timeline semaphore the next
+// graphics submit waits on, so nothing waits for a queue to go idle.
+// Render thread only.
+class VulkanUploader
+{
+  public:
+    VulkanUploader() = delete;
+    // stagingSize bytes of staging memory are shared by all uploads in flight.
+    VulkanUploader(VulkanDevice& device, VkDeviceSize stagingSize);
+    ~VulkanUploader();
+
+    VulkanUploader(const VulkanUploader&)            = delete;
+    VulkanUploader(VulkanUploader&&)                 = delete;
+    VulkanUploader& operator=(const VulkanUploader&) = delete;
+    VulkanUploader& operator=(VulkanUploader&&)      = delete;
+
+    // Stages size bytes of data and records a copy into destination at offset for the
+    // next Flush. Uploads that don't fit the staging ring get a dedicated staging buffer.
+    void Upload(
+        const void*                   data,
+        VkDeviceSize                  size,
+        std::shared_ptr<VulkanBuffer> destination,
+        VkDeviceSize                  offset = 0
+    );
+
+    // Records a copy of all of source into destination at offset for the next Flush,
+    // both are kept alive until the copy has completed.
+    void Copy(
+        std::shared_ptr<VulkanBuffer> source,
+        std::shared_ptr<VulkanBuffer> destination,
+        VkDeviceSize                  offset = 0
+    );
+
+    // Submits the recorded copies, if any, and releases completed ones.
+    void Flush();
+
+  private:
+    struct Batch
+    {
+        VkCommandBuffer                            commandBuffer = VK_NULL_HANDLE;
+        uint64_t                                   value         = 0;
+        std::vector<std::shared_ptr<VulkanBuffer>> buffers;
+    };
+
+    void Begin();
+    void Collect();
+    void Record(
+        VkBuffer            source,
+        VkDeviceSize        sourceOffset,
+        const VulkanBuffer& destination,
+        VkDeviceSize        offset,
+        VkDeviceSize        size
+    );
+
+    VulkanDevice&     m_device;
+    VulkanStagingRing m_staging;
+
+    VkCommandPool m_vkCommandPool;
+    VkSemaphore   m_vkTimeline;
+    uint64_t      m_submitted = 0;
+
+    // commandBuffer is null until the first copy of the batch.
+    Batch                        m_recording;
+    std::deque<Batch>            m_inFlight;
+    std::vector<VkCommandBuffer> m_freeCommandBuffers;
+};
+} // namespace drive
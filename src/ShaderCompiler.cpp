@@ -36,7 +36,7 @@ int main(int argc, char** argv)
         LOG_INFO("Creating target directory '{}'", outDir.string());
         std::filesystem::create_directory(outDir);
 
-        const auto regex       = std::regex(".*\\.(frag|vert)");
+        const auto regex       = std::regex(".*\\.(frag|vert|comp)");
         auto       shaderFiles = std::vector<std::filesystem::path>();
 
         LOG_INFO("Shaders in '{}':", srcDir.string());
@@ -1,17 +1,28 @@
 #version 450
 
-#include "include/VertexPNC.glsl"
+#include "include/VertexTerrain.glsl"
 #include "include/UniformBufferObject.glsl"
 #include "include/Lighting.glsl"
+#include "include/Util.glsl"
+#include "include/TerrainVertex.glsl"
 
-layout(location = 0) out vec3 fragColor;
-layout(location = 1) out vec3 fragPos;
-layout(location = 2) out vec3 fragNormal;
+// TerrainPushConstants in DataTypes.h
+layout(push_constant) uniform TerrainPushConstants
+{
+    vec2 origin;
+    float spacing;
+    float heightScale;
+    uint verticesPerSide;
+    float skirtDepth;
+} chunk;
 
 void main()
 {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-    fragPos = (ubo.model * vec4(inPosition, 1.0)).xyz;
-    fragColor = inColor;
-    fragNormal = (ubo.model * vec4(inNormal, 1.0)).xyz;
+    TerrainVertex(
+        chunk.origin,
+        chunk.spacing,
+        chunk.heightScale,
+        chunk.verticesPerSide,
+        chunk.skirtDepth
+    );
 }
@@ -0,0 +1,36 @@
+#version 450
+
+// Terrain.vert for chunks drawn by TerrainCull.comp, reads the chunk
+// from the draw list instead of push constants.
+
+#include "include/VertexTerrain.glsl"
+#include "include/UniformBufferObject.glsl"
+#include "include/Lighting.glsl"
+#include "include/Util.glsl"
+#include "include/TerrainVertex.glsl"
+#include "include/TerrainDraw.glsl"
+
+// TerrainIndirectPushConstants in DataTypes.h
+layout(push_constant) uniform TerrainIndirectPushConstants
+{
+    float heightScale;
+} terrain;
+
+layout(set = 0, binding = 1) readonly buffer TerrainDraws
+{
+    TerrainDraw draws[];
+};
+
+void main()
+{
+    // The command's firstInstance is the draw's index.
+    TerrainDraw chunk = draws[gl_InstanceIndex];
+
+    TerrainVertex(
+        chunk.origin,
+        chunk.spacing,
+        terrain.heightScale,
+        chunk.verticesPerSide,
+        chunk.skirtDepth
+    );
+}
@@ -0,0 +1,11 @@
+// TerrainDraw in DataTypes.h, one per chunk queued with Renderer::AddTerrainDraw.
+struct TerrainDraw
+{
+    vec2 origin;
+    float spacing;
+    float skirtDepth;
+    vec3 boundsMin;
+    uint verticesPerSide;
+    vec3 boundsMax;
+    int vertexOffset;
+};
@@ -0,0 +1,43 @@
+// Chunk vertex shared by Terrain.vert and TerrainIndirect.vert,
+// include after VertexTerrain, UniformBufferObject and Util.
+
+// Indexed by TerrainMaterial
+const vec3 materialColors[3] = vec3[](
+    vec3(0.0, 0.2, 0.0),   // Grass
+    vec3(0.1, 0.1, 0.1),   // Road
+    vec3(0.2, 0.1, 0.075)  // Road side
+);
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragPos;
+layout(location = 2) out vec3 fragNormal;
+
+void TerrainVertex(vec2 origin, float spacing, float heightScale, uint vps, float skirtDepth)
+{
+    // Chunk vertices are an x-major grid, x/y come from the index.
+    uint index = uint(gl_VertexIndex);
+    uvec2 grid = uvec2(index / vps, index % vps);
+    float drop = 0.0;
+
+    // Skirt vertices follow the grid, one per edge vertex, see Renderer::GenerateGridIndices.
+    if (index >= vps * vps)
+    {
+        uint skirt = index - vps * vps;
+        uint edge = skirt / vps;
+        uint i = skirt % vps;
+        uint last = vps - 1;
+        grid = edge == 0u ? uvec2(0, i)
+            : edge == 1u ? uvec2(last, i)
+            : edge == 2u ? uvec2(i, 0)
+            : uvec2(i, last);
+        drop = skirtDepth;
+    }
+
+    vec2 xy = origin + vec2(grid) * spacing;
+    vec3 position = vec3(xy, inHeight * heightScale - drop);
+
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0);
+    fragPos = (ubo.model * vec4(position, 1.0)).xyz;
+    fragColor = materialColors[min(inMaterial, 2u)];
+    fragNormal = (ubo.model * vec4(OctDecode(inNormal), 1.0)).xyz;
+}
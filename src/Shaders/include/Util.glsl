@@ -12,3 +12,13 @@ vec3 FragWorldPos()
 {
     return (ubo.clipToWorld * FragClipPos()).xyz;
 }
+
+// Inverse of the octahedral mapping in DataTypes.h, e is in [-1, 1].
+vec3 OctDecode(vec2 e)
+{
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
@@ -0,0 +1,3 @@
+layout(location = 0) in vec2 inNormal;
+layout(location = 1) in float inHeight;
+layout(location = 2) in uint inMaterial;
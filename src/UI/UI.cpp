@@ -13,9 +13,14 @@
 namespace drive
 {
 
-UI::UI(std::shared_ptr<Window> window, std::shared_ptr<Renderer> renderer) :
+UI::UI(
+    std::shared_ptr<Window>   window,
+    std::shared_ptr<Renderer> renderer,
+    std::shared_ptr<World>    world
+) :
     m_window(window),
     m_renderer(renderer),
+    m_world(world),
     m_state({})
 {
     LOG_INFO("Creating UI");
@@ -160,6 +165,64 @@ void UI::DebugWindow()
         auto mem = std::format("MEM: {:d} MB", Memory::GetUsage() / 1024);
         ImGui::Text("%s", mem.c_str());
 
+        const auto terrain = m_world->GetTerrainStats();
+        auto       evicted = std::format(
+            "Evicted chunks: {} ({} MB)",
+            terrain.evictedChunks,
+            terrain.evictedBytes / (1024 * 1024)
+        );
+        ImGui::Text("%s", evicted.c_str());
+
+        auto evictedHits = std::format(
+            "  Hits: {} Misses: {}",
+            terrain.evictedHits,
+            terrain.evictedMisses
+        );
+        ImGui::Text("%s", evictedHits.c_str());
+
+        const auto prefetched = terrain.prefetchHits + terrain.prefetchMisses;
+        auto       prefetch   = std::format(
+            "Prefetch hit rate: {:.0f}% ({} staged)",
+            prefetched > 0 ? 100.0 * terrain.prefetchHits / prefetched : 0.0,
+            terrain.prefetchStaged
+        );
+        ImGui::Text("%s", prefetch.c_str());
+
+        auto sliced = std::format(
+            "Sliced generation: {:.2f} ms ({} queued, {} overruns)",
+            terrain.slicedTickMs,
+            terrain.slicedQueued,
+            terrain.slicedOverruns
+        );
+        ImGui::Text("%s", sliced.c_str());
+
+        auto chunks = std::format(
+            "Chunks: {} rendered, {} culled, {} queued for GPU culling",
+            terrain.renderedChunks,
+            terrain.culledChunks,
+            terrain.queuedChunks
+        );
+        ImGui::Text("%s", chunks.c_str());
+
+        // Retained CPU memory per chunk in use, free chunks included.
+        const auto resident = terrain.poolChunks - terrain.poolFree;
+        auto       pool     = std::format(
+            "Chunk pool: {} chunks ({} free, {} grown), {} MB, {} KB per chunk",
+            terrain.poolChunks,
+            terrain.poolFree,
+            terrain.poolGrowths,
+            terrain.poolBytes / (1024 * 1024),
+            resident > 0 ? terrain.poolBytes / resident / 1024 : 0
+        );
+        ImGui::Text("%s", pool.c_str());
+
+        auto slots = std::format(
+            "Vertex slots: {} ({} free)",
+            terrain.vertexSlots,
+            terrain.vertexSlotsFree
+        );
+        ImGui::Text("%s", slots.c_str());
+
         ImGui::End();
     }
 }
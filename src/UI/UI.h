@@ -6,6 +6,7 @@
 
 #include "../Renderer/Vulkan/VulkanRenderer.h"
 #include "../Window/Window.h"
+#include "../World/World.h"
 
 namespace drive
 {
@@ -31,7 +32,11 @@ class UI
     UI& operator=(const UI&) = delete;
     UI& operator=(UI&&)      = delete;
 
-    UI(std::shared_ptr<Window> window, std::shared_ptr<Renderer> renderer);
+    UI(
+        std::shared_ptr<Window>   window,
+        std::shared_ptr<Renderer> renderer,
+        std::shared_ptr<World>    world
+    );
     ~UI();
 
     void ToggleWindow(UIWindow window)
@@ -48,6 +53,7 @@ class UI
 
     std::shared_ptr<Window>   m_window;
     std::shared_ptr<Renderer> m_renderer;
+    std::shared_ptr<World>    m_world;
     VulkanImGuiCreationInfo   m_info;
     UIState                   m_state;
 };
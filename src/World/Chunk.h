@@ -1,34 +1,113 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <span>
+#include <tuple>
 #include <vector>
 
 #include <glm/vec2.hpp>
 
 #include "../Renderer/Buffer.h"
+#include "../Renderer/BufferSlots.h"
 #include "../Renderer/DataTypes.h"
 
 #define CHUNK_SIZE 64
 
 namespace drive
 {
+// Level of detail, x, y (chunk-space at that level).
+using ChunkKey = std::tuple<int, int, int>;
+
 struct Chunk
 {
     glm::ivec2 position;
+    int        lod;
+    float      size;
     glm::vec2  worldPosition;
     glm::vec2  worldCenter;
 
-    std::vector<Vertex_P_N_C> vertices;
-    std::vector<Index>        indices;
+    // Vertex grid, spacing is in world units.
+    uint32_t quadsPerSide;
+    float    spacing;
+
+    // Set when generated with skirts, see Terrain::GenerateSkirts.
+    float skirtDepth;
+
+    // Vertex heights, x-major.
+    std::vector<float> heights;
+
+    // Range of heights, for the bounding box.
+    float minHeight;
+    float maxHeight;
+
+    std::vector<Vertex_Terrain> vertices;
+
+    // Set instead of vertices when they are generated straight into mapped memory,
+    // either mappedBuffer (see Renderer::CreateMappedBuffer) or a mapped vertexSlot.
+    // Cleared once submitted on first render. Write-only, it may be write-combined memory.
+    std::shared_ptr<Buffer>   mappedBuffer;
+    std::span<Vertex_Terrain> mappedVertices;
 
-    std::shared_ptr<Buffer> vertexBuffer;
-    std::shared_ptr<Buffer> indexBuffer;
+    // Vertices on the GPU, in the terrain's shared slot buffer or, when the slots
+    // ran out, a buffer of its own. Indices come from Renderer::GetGridIndexBuffer.
+    std::shared_ptr<BufferSlot> vertexSlot;
+    std::shared_ptr<Buffer>     vertexBuffer;
 
-    Chunk(glm::ivec2 pos)
+    // Grid chunks use the defaults, LOD nodes pass their level and size.
+    Chunk(glm::ivec2 pos, uint32_t quads, int lodLevel = 0, float chunkSize = CHUNK_SIZE)
+    {
+        Reset(pos, quads, lodLevel, chunkSize);
+    }
+
+    // Reinitializes a recycled chunk, see ChunkPool. Storage keeps its capacity.
+    void Reset(glm::ivec2 pos, uint32_t quads, int lodLevel, float chunkSize)
     {
         position      = pos;
-        worldPosition = ChunkToWorld(pos);
-        worldCenter   = worldPosition + glm::vec2(0.5f * CHUNK_SIZE);
+        lod           = lodLevel;
+        size          = chunkSize;
+        worldPosition = glm::vec2(pos) * size;
+        worldCenter   = worldPosition + glm::vec2(0.5f * size);
+        quadsPerSide  = quads;
+        spacing       = size / static_cast<float>(quads);
+        skirtDepth    = 0.0f;
+        minHeight     = 0.0f;
+        maxHeight     = 0.0f;
+        heights.clear();
+        vertices.clear();
+        mappedBuffer   = nullptr;
+        mappedVertices = {};
+        vertexSlot     = nullptr;
+        vertexBuffer   = nullptr;
+    }
+
+    // CPU-side vertices until uploaded, wherever they are.
+    std::span<Vertex_Terrain> GetVertices()
+    {
+        return !mappedVertices.empty() ? mappedVertices : std::span(vertices);
+    }
+
+    std::span<const Vertex_Terrain> GetVertices() const
+    {
+        return !mappedVertices.empty() ? mappedVertices : std::span(vertices);
+    }
+
+    void UpdateHeightBounds()
+    {
+        if (heights.empty())
+        {
+            return;
+        }
+
+        const auto [min, max] = std::ranges::minmax_element(heights);
+        minHeight             = *min;
+        maxHeight             = *max;
+    }
+
+    ChunkKey Key() const
+    {
+        return {lod, position.x, position.y};
     }
 
     static constexpr glm::vec2 ChunkToWorld(glm::ivec2 pos)
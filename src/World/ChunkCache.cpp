@@ -0,0 +1,238 @@
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <system_error>
+
+#if POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../Log.h"
+#include "ChunkCache.h"
+
+namespace drive
+{
+
+ChunkCache::ChunkCache(std::shared_ptr<JobSystem> jobSystem, uint64_t seed, uint32_t version) :
+    m_jobSystem(jobSystem),
+    m_seed(seed),
+    m_version(version)
+{
+    m_directory = std::filesystem::path(CHUNK_CACHE_DIRECTORY)
+                      .append(std::format("{:016x}_v{}", seed, version));
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    m_enabled = !error;
+
+    if (m_enabled)
+    {
+        LOG_INFO("Using chunk cache {}", m_directory.string());
+    }
+    else
+    {
+        LOG_WARNING("Chunk cache disabled, {}: {}", m_directory.string(), error.message());
+    }
+}
+
+ChunkCache::~ChunkCache()
+{
+    // Writes reference this, let them finish.
+    m_jobSystem->Wait(m_pendingWrites);
+
+    LOG_INFO("Chunk cache {} hits, {} misses", m_hits.load(), m_misses.load());
+}
+
+bool ChunkCache::Load(Chunk& chunk)
+{
+    if (!m_enabled)
+    {
+        return false;
+    }
+
+    const auto path   = ChunkPath(chunk);
+    bool       loaded = false;
+
+#if POSIX
+    // Pages are faulted in by the copy, nothing is read up front.
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file >= 0)
+    {
+        struct stat info = {};
+        if (fstat(file, &info) == 0 && info.st_size > 0)
+        {
+            const auto size   = static_cast<size_t>(info.st_size);
+            void*      mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapped != MAP_FAILED)
+            {
+                loaded = Read(chunk, static_cast<const std::byte*>(mapped), size);
+                munmap(mapped, size);
+            }
+        }
+        close(file);
+    }
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (file)
+    {
+        std::vector<std::byte> data(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        loaded = file && Read(chunk, data.data(), data.size());
+    }
+#endif
+
+    if (loaded)
+    {
+        m_hits++;
+    }
+    else
+    {
+        m_misses++;
+    }
+    return loaded;
+}
+
+void ChunkCache::Store(const Chunk& chunk, std::span<const Vertex_Terrain> vertices)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    const Header header {
+        .magic        = m_magic,
+        .version      = m_version,
+        .seed         = m_seed,
+        .lod          = chunk.lod,
+        .x            = chunk.position.x,
+        .y            = chunk.position.y,
+        .quadsPerSide = chunk.quadsPerSide,
+        .size         = chunk.size,
+        .skirtDepth   = chunk.skirtDepth,
+        .heightCount  = static_cast<uint32_t>(chunk.heights.size()),
+        .vertexCount  = static_cast<uint32_t>(vertices.size()),
+    };
+
+    const size_t heightsSize  = chunk.heights.size() * sizeof(float);
+    const size_t verticesSize = vertices.size_bytes();
+
+    // The chunk is handed to the render thread right after this, copy it now.
+    WriteBuffer data;
+    {
+        std::scoped_lock lock {m_bufferMutex};
+        if (!m_freeBuffers.empty())
+        {
+            data = std::move(m_freeBuffers.back());
+            m_freeBuffers.pop_back();
+        }
+    }
+    if (data == nullptr)
+    {
+        data = std::make_shared<std::vector<std::byte>>();
+    }
+    data->resize(sizeof(Header) + heightsSize + verticesSize);
+
+    std::memcpy(data->data(), &header, sizeof(Header));
+    std::memcpy(data->data() + sizeof(Header), chunk.heights.data(), heightsSize);
+    std::memcpy(data->data() + sizeof(Header) + heightsSize, vertices.data(), verticesSize);
+
+    m_jobSystem->Schedule(
+        [this, path = ChunkPath(chunk), data]() {
+            Write(path, *data);
+
+            std::scoped_lock lock {m_bufferMutex};
+            m_freeBuffers.push_back(data);
+        },
+        &m_pendingWrites
+    );
+}
+
+std::filesystem::path ChunkCache::ChunkPath(const Chunk& chunk) const
+{
+    // Grid chunks and LOD nodes differ in resolution at the same key.
+    return std::filesystem::path(m_directory)
+        .append(std::format(
+            "{}_{}_{}_{}.chunk",
+            chunk.lod,
+            chunk.quadsPerSide,
+            chunk.position.x,
+            chunk.position.y
+        ));
+}
+
+bool ChunkCache::Read(Chunk& chunk, const std::byte* data, size_t size) const
+{
+    if (size < sizeof(Header))
+    {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+
+    if (header.magic != m_magic || header.version != m_version || header.seed != m_seed
+        || header.lod != chunk.lod || header.x != chunk.position.x
+        || header.y != chunk.position.y || header.quadsPerSide != chunk.quadsPerSide
+        || header.size != chunk.size)
+    {
+        return false;
+    }
+
+    const size_t heightsSize  = header.heightCount * sizeof(float);
+    const size_t verticesSize = header.vertexCount * sizeof(Vertex_Terrain);
+    if (size != sizeof(Header) + heightsSize + verticesSize)
+    {
+        return false;
+    }
+
+    // Mapped vertices are already sized for the chunk.
+    if (!chunk.mappedVertices.empty() && chunk.mappedVertices.size() != header.vertexCount)
+    {
+        return false;
+    }
+
+    chunk.skirtDepth = header.skirtDepth;
+    chunk.heights.resize(header.heightCount);
+    if (chunk.mappedVertices.empty())
+    {
+        chunk.vertices.resize(header.vertexCount);
+    }
+    std::memcpy(chunk.heights.data(), data + sizeof(Header), heightsSize);
+    std::memcpy(chunk.GetVertices().data(), data + sizeof(Header) + heightsSize, verticesSize);
+    chunk.UpdateHeightBounds();
+
+    return true;
+}
+
+void ChunkCache::Write(const std::filesystem::path& path, const std::vector<std::byte>& data)
+{
+    // Readers only ever see complete files.
+    auto tempPath = path;
+    tempPath.concat(std::format(".{}.tmp", m_writeIndex++));
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(
+            reinterpret_cast<const char*>(data.data()),
+            static_cast<std::streamsize>(data.size())
+        );
+        if (!file)
+        {
+            LOG_WARNING("Failed to write chunk cache {}", tempPath.string());
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        LOG_WARNING("Failed to write chunk cache {}: {}", path.string(), error.message());
+        std::filesystem::remove(tempPath, error);
+    }
+}
+}; // namespace drive
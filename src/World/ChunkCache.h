@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "../Jobs/JobSystem.h"
+#include "Chunk.h"
+
+#define CHUNK_CACHE_DIRECTORY "cache/terrain"
+
+namespace drive
+{
+// Generated chunks on disk, one file per chunk in a directory for the seed and
+// generator version. Loads map the file and copy straight into the chunk.
+class ChunkCache
+{
+  public:
+    ChunkCache() = delete;
+    ChunkCache(std::shared_ptr<JobSystem> jobSystem, uint64_t seed, uint32_t version);
+    ~ChunkCache();
+
+    ChunkCache(const ChunkCache&)            = delete;
+    ChunkCache(ChunkCache&&)                 = delete;
+    ChunkCache& operator=(const ChunkCache&) = delete;
+    ChunkCache& operator=(ChunkCache&&)      = delete;
+
+    // Fills heights, vertices and skirt depth of a chunk.
+    // Returns false if the chunk is not cached.
+    bool Load(Chunk& chunk);
+
+    // Copies the chunk data and writes it on a worker. vertices are CPU-side,
+    // never the chunk's mapped ones, which may be write-combined memory.
+    void Store(const Chunk& chunk, std::span<const Vertex_Terrain> vertices);
+
+  private:
+    // Precedes heights and vertices in a chunk file.
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t seed;
+        int32_t  lod;
+        int32_t  x;
+        int32_t  y;
+        uint32_t quadsPerSide;
+        float    size;
+        float    skirtDepth;
+        uint32_t heightCount;
+        uint32_t vertexCount;
+    };
+
+    static constexpr uint32_t m_magic = 0x4b4e4843; // CHNK
+
+    std::filesystem::path ChunkPath(const Chunk& chunk) const;
+
+    // Validates a mapped file against the chunk and copies it in.
+    bool Read(Chunk& chunk, const std::byte* data, size_t size) const;
+    void Write(const std::filesystem::path& path, const std::vector<std::byte>& data);
+
+    std::shared_ptr<JobSystem> m_jobSystem;
+    JobCounter                 m_pendingWrites;
+
+    // Disabled if the directory can't be created.
+    bool                  m_enabled;
+    std::filesystem::path m_directory;
+    uint64_t              m_seed;
+    uint32_t              m_version;
+
+    // Unique temporary file names, finished files are renamed into place.
+    std::atomic<uint32_t> m_writeIndex {0};
+
+    // Serialised chunks, reused once written so stores keep their capacity.
+    using WriteBuffer = std::shared_ptr<std::vector<std::byte>>;
+    std::mutex               m_bufferMutex;
+    std::vector<WriteBuffer> m_freeBuffers;
+
+    std::atomic<uint32_t> m_hits {0};
+    std::atomic<uint32_t> m_misses {0};
+};
+}; // namespace drive
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "ChunkGrid.h"
+
+namespace drive
+{
+
+ChunkGrid::ChunkGrid(int radius) :
+    m_radius(std::max(radius, 0)),
+    m_size(2 * m_radius + 1),
+    m_center(0, 0),
+    m_slots(static_cast<size_t>(m_size * m_size))
+{
+}
+
+bool ChunkGrid::Contains(glm::ivec2 position, glm::ivec2 center) const
+{
+    return std::abs(position.x - center.x) <= m_radius
+        && std::abs(position.y - center.y) <= m_radius;
+}
+
+std::shared_ptr<Chunk> ChunkGrid::Get(glm::ivec2 position) const
+{
+    if (!Contains(position))
+    {
+        return nullptr;
+    }
+
+    const auto& chunk = m_slots[Slot(position)];
+    if (chunk == nullptr || chunk->position != position)
+    {
+        return nullptr;
+    }
+    return chunk;
+}
+
+bool ChunkGrid::Set(std::shared_ptr<Chunk> chunk)
+{
+    if (!Contains(chunk->position))
+    {
+        return false;
+    }
+
+    auto& slot = m_slots[Slot(chunk->position)];
+    if (slot != nullptr)
+    {
+        return false;
+    }
+
+    slot = std::move(chunk);
+    return true;
+}
+
+void ChunkGrid::SetCenter(glm::ivec2 center, std::vector<std::shared_ptr<Chunk>>& evicted)
+{
+    const auto delta = center - m_center;
+    const auto old   = m_center;
+    m_center         = center;
+
+    // Nothing stays, every slot changes.
+    if (std::abs(delta.x) >= m_size || std::abs(delta.y) >= m_size)
+    {
+        for (auto& slot : m_slots)
+        {
+            if (slot != nullptr)
+            {
+                evicted.push_back(std::move(slot));
+                slot = nullptr;
+            }
+        }
+        return;
+    }
+
+    // Columns and rows of the old grid that are outside the new one,
+    // their slots are the ones the new columns and rows map to.
+    const int stepX = delta.x > 0 ? 1 : -1;
+    for (int i = 0; i < std::abs(delta.x); i++)
+    {
+        const int x = old.x - stepX * (m_radius - i);
+        for (int y = old.y - m_radius; y <= old.y + m_radius; y++)
+        {
+            EvictSlot({x, y}, evicted);
+        }
+    }
+
+    const int stepY = delta.y > 0 ? 1 : -1;
+    for (int i = 0; i < std::abs(delta.y); i++)
+    {
+        const int y = old.y - stepY * (m_radius - i);
+        for (int x = old.x - m_radius; x <= old.x + m_radius; x++)
+        {
+            EvictSlot({x, y}, evicted);
+        }
+    }
+}
+
+size_t ChunkGrid::Slot(glm::ivec2 position) const
+{
+    int x = position.x % m_size;
+    int y = position.y % m_size;
+    if (x < 0)
+    {
+        x += m_size;
+    }
+    if (y < 0)
+    {
+        y += m_size;
+    }
+    return static_cast<size_t>(x * m_size + y);
+}
+
+void ChunkGrid::EvictSlot(glm::ivec2 position, std::vector<std::shared_ptr<Chunk>>& evicted)
+{
+    auto& slot = m_slots[Slot(position)];
+    if (slot != nullptr && !Contains(slot->position))
+    {
+        evicted.push_back(std::move(slot));
+        slot = nullptr;
+    }
+}
+}; // namespace drive
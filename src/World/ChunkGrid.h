@@ -0,0 +1,77 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "Chunk.h"
+
+namespace drive
+{
+// Square grid of chunks within radius of a center (chunk-space).
+// Slots are addressed toroidally, a position always maps to the same slot,
+// so moving the center only touches the rows and columns that left the grid.
+class ChunkGrid
+{
+  public:
+    ChunkGrid() = delete;
+    ChunkGrid(int radius);
+
+    ChunkGrid(const ChunkGrid&)            = delete;
+    ChunkGrid(ChunkGrid&&)                 = delete;
+    ChunkGrid& operator=(const ChunkGrid&) = delete;
+    ChunkGrid& operator=(ChunkGrid&&)      = delete;
+
+    int GetRadius() const
+    {
+        return m_radius;
+    }
+
+    // Chunks per side.
+    int GetSize() const
+    {
+        return m_size;
+    }
+
+    glm::ivec2 GetCenter() const
+    {
+        return m_center;
+    }
+
+    bool Contains(glm::ivec2 position) const
+    {
+        return Contains(position, m_center);
+    }
+
+    // Whether position is in the grid if it was centered at center.
+    bool Contains(glm::ivec2 position, glm::ivec2 center) const;
+
+    // nullptr if position is outside the grid or not loaded.
+    std::shared_ptr<Chunk> Get(glm::ivec2 position) const;
+
+    // Places a chunk at its position.
+    // Returns false if the position is outside the grid or already loaded.
+    bool Set(std::shared_ptr<Chunk> chunk);
+
+    // Removes the chunks that fall outside the grid at the new center into evicted.
+    void SetCenter(glm::ivec2 center, std::vector<std::shared_ptr<Chunk>>& evicted);
+
+    // All slots, in no particular order. Empty slots are nullptr.
+    const std::vector<std::shared_ptr<Chunk>>& GetSlots() const
+    {
+        return m_slots;
+    }
+
+  private:
+    size_t Slot(glm::ivec2 position) const;
+
+    // Evicts the chunk in a slot if it is no longer in the grid.
+    void EvictSlot(glm::ivec2 position, std::vector<std::shared_ptr<Chunk>>& evicted);
+
+    int                                 m_radius;
+    int                                 m_size;
+    glm::ivec2                          m_center;
+    std::vector<std::shared_ptr<Chunk>> m_slots;
+};
+}; // namespace drive
@@ -0,0 +1,56 @@
+#include <iterator>
+
+#include "ChunkLru.h"
+
+namespace drive
+{
+
+ChunkLru::ChunkLru(size_t budget) :
+    m_budget(budget)
+{
+}
+
+void ChunkLru::Insert(std::shared_ptr<Chunk> chunk, size_t bytes)
+{
+    const auto key      = chunk->Key();
+    const auto existing = m_index.find(key);
+    if (existing != m_index.end())
+    {
+        Erase(existing->second);
+    }
+
+    m_entries.push_front({key, std::move(chunk), bytes});
+    m_index.emplace(key, m_entries.begin());
+    m_count.store(m_index.size(), std::memory_order_relaxed);
+    m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    while (!m_entries.empty() && GetBytes() > m_budget)
+    {
+        Erase(std::prev(m_entries.end()));
+    }
+}
+
+std::shared_ptr<Chunk> ChunkLru::Take(ChunkKey key)
+{
+    const auto entry = m_index.find(key);
+    if (entry == m_index.end())
+    {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+
+    auto chunk = std::move(entry->second->chunk);
+    Erase(entry->second);
+    return chunk;
+}
+
+void ChunkLru::Erase(std::list<Entry>::iterator entry)
+{
+    m_bytes.fetch_sub(entry->bytes, std::memory_order_relaxed);
+    m_index.erase(entry->key);
+    m_entries.erase(entry);
+    m_count.store(m_index.size(), std::memory_order_relaxed);
+}
+}; // namespace drive
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+
+#include "Chunk.h"
+
+namespace drive
+{
+// Chunks that fell out of the loaded area, with their vertex buffers.
+// The least recently evicted are dropped once over the memory budget.
+// Not thread-safe apart from the counters, owned by the tick thread.
+class ChunkLru
+{
+  public:
+    ChunkLru() = delete;
+    ChunkLru(size_t budget);
+
+    ChunkLru(const ChunkLru&)            = delete;
+    ChunkLru(ChunkLru&&)                 = delete;
+    ChunkLru& operator=(const ChunkLru&) = delete;
+    ChunkLru& operator=(ChunkLru&&)      = delete;
+
+    // bytes is the CPU and GPU memory held by the chunk.
+    void Insert(std::shared_ptr<Chunk> chunk, size_t bytes);
+
+    // Removes a chunk to be loaded again, nullptr on a miss.
+    std::shared_ptr<Chunk> Take(ChunkKey key);
+
+    uint32_t GetHits() const
+    {
+        return m_hits.load(std::memory_order_relaxed);
+    }
+
+    uint32_t GetMisses() const
+    {
+        return m_misses.load(std::memory_order_relaxed);
+    }
+
+    size_t GetCount() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    size_t GetBytes() const
+    {
+        return m_bytes.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Entry
+    {
+        ChunkKey               key;
+        std::shared_ptr<Chunk> chunk;
+        size_t                 bytes;
+    };
+
+    void Erase(std::list<Entry>::iterator entry);
+
+    size_t m_budget;
+
+    // Most recently evicted first.
+    std::list<Entry>                                m_entries;
+    std::map<ChunkKey, std::list<Entry>::iterator> m_index;
+
+    std::atomic<uint32_t> m_hits {0};
+    std::atomic<uint32_t> m_misses {0};
+    std::atomic<size_t>   m_count {0};
+    std::atomic<size_t>   m_bytes {0};
+};
+}; // namespace drive
@@ -0,0 +1,155 @@
+#include <atomic>
+#include <utility>
+
+#include "ChunkPool.h"
+
+namespace drive
+{
+
+ChunkPool::ChunkPool(size_t capacity, size_t heightCount, size_t vertexCount, size_t apronCount) :
+    m_heightCount(heightCount),
+    m_vertexCount(vertexCount),
+    m_apronCount(apronCount)
+{
+    m_chunks.reserve(capacity);
+    m_inUse.reserve(capacity);
+    m_freeChunks.reserve(capacity);
+
+    // Chunks are reset on acquire, the placeholder layout doesn't matter.
+    for (size_t i = 0; i < capacity; i++)
+    {
+        auto chunk = std::make_shared<Chunk>(glm::ivec2(0, 0), 1);
+        chunk->heights.reserve(m_heightCount);
+
+        m_chunks.push_back(std::move(chunk));
+        m_inUse.push_back(0);
+        m_freeChunks.push_back(i);
+    }
+
+    m_count.store(m_chunks.size(), std::memory_order_relaxed);
+    m_free.store(m_freeChunks.size(), std::memory_order_relaxed);
+    m_bytes.store(
+        capacity * (sizeof(Chunk) + m_heightCount * sizeof(float)),
+        std::memory_order_relaxed
+    );
+}
+
+std::shared_ptr<Chunk> ChunkPool::Acquire(glm::ivec2 pos, uint32_t quads, int lod, float size)
+{
+    if (m_freeChunks.empty())
+    {
+        auto chunk = std::make_shared<Chunk>(glm::ivec2(0, 0), 1);
+        chunk->heights.reserve(m_heightCount);
+
+        m_freeChunks.push_back(m_chunks.size());
+        m_chunks.push_back(std::move(chunk));
+        m_inUse.push_back(0);
+
+        m_count.store(m_chunks.size(), std::memory_order_relaxed);
+        m_bytes.fetch_add(sizeof(Chunk) + m_heightCount * sizeof(float), std::memory_order_relaxed);
+        m_growths.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const size_t index = m_freeChunks.back();
+    m_freeChunks.pop_back();
+    m_free.store(m_freeChunks.size(), std::memory_order_relaxed);
+
+    m_inUse[index] = 1;
+    m_chunks[index]->Reset(pos, quads, lod, size);
+    return m_chunks[index];
+}
+
+void ChunkPool::Collect()
+{
+    for (size_t i = 0; i < m_chunks.size(); i++)
+    {
+        if (m_inUse[i] == 0 || m_chunks[i].use_count() != 1)
+        {
+            continue;
+        }
+
+        // The last owner may have released it on another thread, see its writes.
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        Recycle(*m_chunks[i]);
+        m_inUse[i] = 0;
+        m_freeChunks.push_back(i);
+    }
+
+    m_free.store(m_freeChunks.size(), std::memory_order_relaxed);
+}
+
+void ChunkPool::AcquireVertices(std::vector<Vertex_Terrain>& vertices)
+{
+    if (vertices.capacity() >= m_vertexCount)
+    {
+        return;
+    }
+
+    {
+        std::scoped_lock lock {m_storageMutex};
+        if (!m_freeVertices.empty())
+        {
+            vertices.swap(m_freeVertices.back());
+            m_freeVertices.pop_back();
+            return;
+        }
+    }
+
+    vertices.reserve(m_vertexCount);
+    m_bytes.fetch_add(m_vertexCount * sizeof(Vertex_Terrain), std::memory_order_relaxed);
+}
+
+void ChunkPool::ReleaseVertices(std::vector<Vertex_Terrain>& vertices)
+{
+    if (m_vertexCount == 0 || vertices.capacity() < m_vertexCount)
+    {
+        return;
+    }
+
+    vertices.clear();
+
+    std::scoped_lock lock {m_storageMutex};
+    m_freeVertices.push_back(std::move(vertices));
+    vertices = {};
+}
+
+std::unique_ptr<ChunkScratch> ChunkPool::AcquireScratch()
+{
+    {
+        std::scoped_lock lock {m_storageMutex};
+        if (!m_freeScratch.empty())
+        {
+            auto scratch = std::move(m_freeScratch.back());
+            m_freeScratch.pop_back();
+            return scratch;
+        }
+    }
+
+    auto scratch = std::make_unique<ChunkScratch>();
+    scratch->heightfield.resize(m_apronCount);
+    scratch->road.resize(m_apronCount);
+    scratch->vertices.reserve(m_vertexCount);
+    m_bytes.fetch_add(
+        2 * m_apronCount * sizeof(float) + m_vertexCount * sizeof(Vertex_Terrain),
+        std::memory_order_relaxed
+    );
+    return scratch;
+}
+
+void ChunkPool::ReleaseScratch(std::unique_ptr<ChunkScratch> scratch)
+{
+    std::scoped_lock lock {m_storageMutex};
+    m_freeScratch.push_back(std::move(scratch));
+}
+
+void ChunkPool::Recycle(Chunk& chunk)
+{
+    chunk.vertexSlot   = nullptr;
+    chunk.vertexBuffer = nullptr;
+    chunk.mappedBuffer = nullptr;
+    chunk.heights.clear();
+    ReleaseVertices(chunk.vertices);
+    chunk.vertices.clear();
+}
+}; // namespace drive
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "Chunk.h"
+
+namespace drive
+{
+// Apron-sized heightfield and road noise a chunk is generated from.
+struct ChunkScratch
+{
+    std::vector<float> heightfield;
+    std::vector<float> road;
+    // Vertices of chunks generated into mapped memory, built here and copied over.
+    std::vector<Vertex_Terrain> vertices {};
+
+    // Noise positions and the coarse lattice of Terrain::GenerateHeightfield,
+    // sized on first use and kept with the scratch.
+    std::vector<float> sampleX {};
+    std::vector<float> sampleY {};
+    std::vector<float> nodeX {};
+    std::vector<float> nodeY {};
+    std::vector<float> coarseTerrain {};
+    std::vector<float> coarseRoad {};
+    std::vector<float> rowTerrain {};
+    std::vector<float> rowRoad {};
+};
+
+// Arena of chunks and the storage they are generated into, sized for one chunk layout.
+// The pool holds a reference to every chunk it hands out, a chunk only the pool
+// references is free again, so owners never return chunks explicitly.
+// Storage keeps its capacity when recycled, once the arena has grown to the peak
+// number of chunks in flight, streaming no longer allocates.
+class ChunkPool
+{
+  public:
+    ChunkPool() = delete;
+    // heights and vertices per chunk, 0 for chunks without CPU-side data.
+    ChunkPool(size_t capacity, size_t heightCount, size_t vertexCount, size_t apronCount);
+
+    ChunkPool(const ChunkPool&)            = delete;
+    ChunkPool(ChunkPool&&)                 = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+    ChunkPool& operator=(ChunkPool&&)      = delete;
+
+    // Grows the arena if every chunk is in use. Tick thread only, as is Collect.
+    std::shared_ptr<Chunk> Acquire(glm::ivec2 pos, uint32_t quads, int lod, float size);
+
+    // Recycles chunks no longer referenced outside the pool.
+    void Collect();
+
+    // Swaps pooled vertex storage into vertices, thread-safe.
+    void AcquireVertices(std::vector<Vertex_Terrain>& vertices);
+    // Takes the storage back once the vertices are uploaded, thread-safe.
+    void ReleaseVertices(std::vector<Vertex_Terrain>& vertices);
+
+    // Thread-safe.
+    std::unique_ptr<ChunkScratch> AcquireScratch();
+    void                          ReleaseScratch(std::unique_ptr<ChunkScratch> scratch);
+
+    // Chunks in the arena, in use or free.
+    size_t GetCount() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    size_t GetFree() const
+    {
+        return m_free.load(std::memory_order_relaxed);
+    }
+
+    // CPU memory retained by the arena.
+    size_t GetBytes() const
+    {
+        return m_bytes.load(std::memory_order_relaxed);
+    }
+
+    // Times the arena grew past its initial capacity.
+    uint32_t GetGrowths() const
+    {
+        return m_growths.load(std::memory_order_relaxed);
+    }
+
+  private:
+    void Recycle(Chunk& chunk);
+
+    size_t m_heightCount;
+    size_t m_vertexCount;
+    size_t m_apronCount;
+
+    // Every chunk ever handed out and whether it is in use, parallel.
+    std::vector<std::shared_ptr<Chunk>> m_chunks;
+    std::vector<uint8_t>                m_inUse;
+    std::vector<size_t>                 m_freeChunks;
+
+    std::mutex                                 m_storageMutex;
+    std::vector<std::vector<Vertex_Terrain>>   m_freeVertices;
+    std::vector<std::unique_ptr<ChunkScratch>> m_freeScratch;
+
+    std::atomic<size_t>   m_count {0};
+    std::atomic<size_t>   m_free {0};
+    std::atomic<size_t>   m_bytes {0};
+    std::atomic<uint32_t> m_growths {0};
+};
+}; // namespace drive
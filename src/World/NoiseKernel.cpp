@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#if _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "../Log.h"
+#include "NoiseKernel.h"
+
+namespace drive
+{
+NoiseKernel::NoiseKernel(const siv::BasicPerlinNoise<float>& perlin) : m_perlin(perlin)
+{
+    const auto& state = perlin.serialize();
+    for (size_t i = 0; i < m_permutation.size(); i++)
+    {
+        m_permutation[i] = state[i & 255];
+    }
+
+    m_isa = DetectIsa();
+
+    // Kernels mirror the reference arithmetic, but a compiler contracting into FMA
+    // or a PerlinNoise update could still make them drift. Prefer correctness.
+    const auto error = Validate(m_isa);
+    if (error > NOISE_KERNEL_TOLERANCE)
+    {
+        LOG_WARNING(
+            "Noise kernel {} differs from reference by {}, using scalar",
+            GetIsaName(m_isa),
+            error
+        );
+        m_isa = NoiseIsa::SCALAR;
+    }
+    else
+    {
+        LOG_INFO("Using noise kernel {}, max error {}", GetIsaName(m_isa), error);
+    }
+}
+
+void NoiseKernel::Octave2D_01(const NoiseBatch& batch) const
+{
+    Run(m_isa, batch);
+}
+
+const char* NoiseKernel::GetIsaName(NoiseIsa isa)
+{
+    switch (isa)
+    {
+        case NoiseIsa::SCALAR:
+            return "scalar";
+        case NoiseIsa::SSE2:
+            return "SSE2";
+        case NoiseIsa::AVX2:
+            return "AVX2";
+        case NoiseIsa::AVX512:
+            return "AVX-512";
+    }
+    return "unknown";
+}
+
+NoiseIsa NoiseKernel::DetectIsa()
+{
+#if __GNUC__ && __x86_64__
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return NoiseIsa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return NoiseIsa::AVX2;
+    }
+    return NoiseIsa::SSE2;
+#elif _MSC_VER && _M_X64
+    int info[4];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx     = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx)
+    {
+        return NoiseIsa::SSE2;
+    }
+
+    // OS must save the YMM (and ZMM) state.
+    const auto xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6)
+    {
+        return NoiseIsa::AVX512;
+    }
+    if ((info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6)
+    {
+        return NoiseIsa::AVX2;
+    }
+    return NoiseIsa::SSE2;
+#else
+    return NoiseIsa::SCALAR;
+#endif
+}
+
+void NoiseKernel::Run(NoiseIsa isa, const NoiseBatch& batch) const
+{
+    switch (isa)
+    {
+#if __x86_64__ || _M_X64
+        case NoiseIsa::SSE2:
+            NoiseKernelSse2(m_permutation, batch);
+            return;
+        case NoiseIsa::AVX2:
+            NoiseKernelAvx2(m_permutation, batch);
+            return;
+        case NoiseIsa::AVX512:
+            NoiseKernelAvx512(m_permutation, batch);
+            return;
+#endif
+        default:
+            break;
+    }
+
+    if (batch.firstOctave == 0 && !batch.raw)
+    {
+        for (size_t i = 0; i < batch.count; i++)
+        {
+            const float x = batch.x[i];
+            const float y = batch.y[i];
+
+            batch.out[i] = m_perlin.octave2D_01(x, y, batch.octaves);
+            if (batch.partialOut != nullptr)
+            {
+                batch.partialOut[i] = m_perlin.octave2D_01(x, y, batch.partialOctaves);
+            }
+        }
+        return;
+    }
+
+    const auto finish = [&](float sum) {
+        return batch.raw ? sum : std::clamp(sum * 0.5f + 0.5f, 0.0f, 1.0f);
+    };
+
+    for (size_t i = 0; i < batch.count; i++)
+    {
+        float x         = batch.x[i];
+        float y         = batch.y[i];
+        float sum       = 0.0f;
+        float amplitude = 1.0f;
+
+        for (int octave = 0; octave < batch.octaves; octave++)
+        {
+            if (octave >= batch.firstOctave)
+            {
+                sum += m_perlin.noise2D(x, y) * amplitude;
+            }
+            x         *= 2.0f;
+            y         *= 2.0f;
+            amplitude *= 0.5f;
+
+            if (batch.partialOut != nullptr && octave + 1 == batch.partialOctaves)
+            {
+                batch.partialOut[i] = finish(sum);
+            }
+        }
+
+        batch.out[i] = finish(sum);
+    }
+}
+
+// Returns the max absolute difference to siv::PerlinNoise over random samples.
+float NoiseKernel::Validate(NoiseIsa isa) const
+{
+    if (isa == NoiseIsa::SCALAR)
+    {
+        return 0.0f;
+    }
+
+    // Odd count to exercise the remainder path.
+    const size_t count          = 4099;
+    const int    octaves        = 6;
+    const int    partialOctaves = 3;
+
+    std::mt19937                          rng(1234);
+    std::uniform_real_distribution<float> dist(-300.0f, 300.0f);
+
+    std::vector<float> x(count);
+    std::vector<float> y(count);
+    std::vector<float> out(count);
+    std::vector<float> partialOut(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        x[i] = dist(rng);
+        y[i] = dist(rng);
+    }
+
+    const NoiseBatch batch {
+        .x              = x.data(),
+        .y              = y.data(),
+        .count          = count,
+        .octaves        = octaves,
+        .out            = out.data(),
+        .partialOctaves = partialOctaves,
+        .partialOut     = partialOut.data(),
+    };
+    Run(isa, batch);
+
+    float error = 0.0f;
+    for (size_t i = 0; i < count; i++)
+    {
+        const float expected        = m_perlin.octave2D_01(x[i], y[i], octaves);
+        const float expectedPartial = m_perlin.octave2D_01(x[i], y[i], partialOctaves);
+
+        error = std::max(error, std::abs(out[i] - expected));
+        error = std::max(error, std::abs(partialOut[i] - expectedPartial));
+    }
+
+    // Raw sums of the octaves after the first, as used by multi-resolution terrain.
+    const int  firstOctave = 1;
+    NoiseBatch rawBatch    = batch;
+    rawBatch.firstOctave   = firstOctave;
+    rawBatch.raw           = true;
+    Run(isa, rawBatch);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const float skipped         = m_perlin.octave2D(x[i], y[i], firstOctave);
+        const float expected        = m_perlin.octave2D(x[i], y[i], octaves) - skipped;
+        const float expectedPartial = m_perlin.octave2D(x[i], y[i], partialOctaves) - skipped;
+
+        error = std::max(error, std::abs(out[i] - expected));
+        error = std::max(error, std::abs(partialOut[i] - expectedPartial));
+    }
+
+    return error;
+}
+} // namespace drive
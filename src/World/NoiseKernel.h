@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <PerlinNoise.hpp>
+
+// Max allowed difference between the batched kernel and siv::PerlinNoise.
+#define NOISE_KERNEL_TOLERANCE 1e-5f
+
+namespace drive
+{
+enum class NoiseIsa
+{
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512,
+};
+
+// A batch of octave2D_01 evaluations over SoA sample positions.
+// The fBm sum of the first partialOctaves is a prefix of the full sum,
+// so both can be written in the same pass.
+struct NoiseBatch
+{
+    const float* x     = nullptr;
+    const float* y     = nullptr;
+    size_t       count = 0;
+
+    int    octaves = 0;
+    float* out     = nullptr;
+
+    // Optional, must be in [1, octaves] when partialOut is set.
+    int    partialOctaves = 0;
+    float* partialOut     = nullptr;
+
+    // Octaves before firstOctave are skipped, the rest keep their frequency and amplitude.
+    // Partial sums then cover [firstOctave, partialOctaves).
+    int firstOctave = 0;
+
+    // Write the fBm sums as is instead of remapped and clamped to [0, 1],
+    // for adding sums of separate octave ranges.
+    bool raw = false;
+};
+
+// Doubled permutation table, indices up to 511 need no wrapping.
+using NoisePermutation = std::array<int32_t, 512>;
+
+// Batched Perlin fBm matching siv::BasicPerlinNoise<float>::octave2D_01,
+// vectorized with the widest instruction set the CPU supports.
+class NoiseKernel
+{
+  public:
+    NoiseKernel() = delete;
+    NoiseKernel(const siv::BasicPerlinNoise<float>& perlin);
+
+    NoiseKernel(const NoiseKernel&)            = delete;
+    NoiseKernel(NoiseKernel&&)                 = delete;
+    NoiseKernel& operator=(const NoiseKernel&) = delete;
+    NoiseKernel& operator=(NoiseKernel&&)      = delete;
+
+    // Thread-safe.
+    void Octave2D_01(const NoiseBatch& batch) const;
+
+    NoiseIsa GetIsa() const
+    {
+        return m_isa;
+    }
+
+    // Doubled permutation table, also used by TerrainGen.comp.
+    const NoisePermutation& GetPermutation() const
+    {
+        return m_permutation;
+    }
+
+    static const char* GetIsaName(NoiseIsa isa);
+
+  private:
+    static NoiseIsa DetectIsa();
+
+    void  Run(NoiseIsa isa, const NoiseBatch& batch) const;
+    float Validate(NoiseIsa isa) const;
+
+    const siv::BasicPerlinNoise<float>& m_perlin;
+    NoisePermutation                    m_permutation;
+    NoiseIsa                            m_isa;
+};
+
+// Per instruction set kernels, compiled in their own translation units.
+void NoiseKernelSse2(const NoisePermutation& permutation, const NoiseBatch& batch);
+void NoiseKernelAvx2(const NoisePermutation& permutation, const NoiseBatch& batch);
+void NoiseKernelAvx512(const NoisePermutation& permutation, const NoiseBatch& batch);
+} // namespace drive
@@ -0,0 +1,134 @@
+#include <cstddef>
+#include <cstdint>
+
+#include "NoiseKernel.h"
+
+#if __x86_64__ || _M_X64
+
+// Only functions below this point may use AVX2, NoiseKernel checks the CPU before calling in.
+// FMA is deliberately left out so products are not contracted.
+#if __GNUC__
+#pragma GCC target("avx2")
+#endif
+
+#include <immintrin.h>
+
+#include "NoiseKernelImpl.h"
+
+namespace drive
+{
+namespace
+{
+struct Avx2Lanes
+{
+    using Float = __m256;
+    using Int   = __m256i;
+    using Mask  = __m256i;
+
+    static constexpr size_t width = 8;
+
+    static Float Load(const float* p)
+    {
+        return _mm256_loadu_ps(p);
+    }
+
+    static void Store(float* p, Float v)
+    {
+        _mm256_storeu_ps(p, v);
+    }
+
+    static Float Set(float v)
+    {
+        return _mm256_set1_ps(v);
+    }
+
+    static Int SetInt(int32_t v)
+    {
+        return _mm256_set1_epi32(v);
+    }
+
+    static Float Add(Float a, Float b)
+    {
+        return _mm256_add_ps(a, b);
+    }
+
+    static Int Add(Int a, Int b)
+    {
+        return _mm256_add_epi32(a, b);
+    }
+
+    static Float Sub(Float a, Float b)
+    {
+        return _mm256_sub_ps(a, b);
+    }
+
+    static Float Mul(Float a, Float b)
+    {
+        return _mm256_mul_ps(a, b);
+    }
+
+    static Float Min(Float a, Float b)
+    {
+        return _mm256_min_ps(a, b);
+    }
+
+    static Float Max(Float a, Float b)
+    {
+        return _mm256_max_ps(a, b);
+    }
+
+    static Float Floor(Float v)
+    {
+        return _mm256_floor_ps(v);
+    }
+
+    static Int ToInt(Float v)
+    {
+        return _mm256_cvttps_epi32(v);
+    }
+
+    static Int And(Int a, int32_t b)
+    {
+        return _mm256_and_si256(a, _mm256_set1_epi32(b));
+    }
+
+    static Mask Less(Int a, int32_t b)
+    {
+        return _mm256_cmpgt_epi32(_mm256_set1_epi32(b), a);
+    }
+
+    static Mask Equal(Int a, int32_t b)
+    {
+        return _mm256_cmpeq_epi32(a, _mm256_set1_epi32(b));
+    }
+
+    static Mask Or(Mask a, Mask b)
+    {
+        return _mm256_or_si256(a, b);
+    }
+
+    static Float Select(Mask mask, Float a, Float b)
+    {
+        return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(mask));
+    }
+
+    static Float Negate(Mask mask, Float v)
+    {
+        const Float sign = _mm256_and_ps(_mm256_castsi256_ps(mask), _mm256_set1_ps(-0.0f));
+        return _mm256_xor_ps(v, sign);
+    }
+
+    static Int Gather(const int32_t* table, Int index)
+    {
+        return _mm256_i32gather_epi32(table, index, 4);
+    }
+};
+} // namespace
+
+void NoiseKernelAvx2(const NoisePermutation& permutation, const NoiseBatch& batch)
+{
+    Octave2D01<Avx2Lanes>(permutation, batch);
+}
+} // namespace drive
+
+#endif
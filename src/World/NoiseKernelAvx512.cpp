@@ -0,0 +1,138 @@
+#include <cstddef>
+#include <cstdint>
+
+#include "NoiseKernel.h"
+
+#if __x86_64__ || _M_X64
+
+// Only functions below this point may use AVX-512, NoiseKernel checks the CPU before calling in.
+// AVX-512F brings FMA along, keep products uncontracted to match the scalar reference.
+#if __GNUC__
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include <immintrin.h>
+
+#include "NoiseKernelImpl.h"
+
+namespace drive
+{
+namespace
+{
+struct Avx512Lanes
+{
+    using Float = __m512;
+    using Int   = __m512i;
+    using Mask  = __mmask16;
+
+    static constexpr size_t width = 16;
+
+    static Float Load(const float* p)
+    {
+        return _mm512_loadu_ps(p);
+    }
+
+    static void Store(float* p, Float v)
+    {
+        _mm512_storeu_ps(p, v);
+    }
+
+    static Float Set(float v)
+    {
+        return _mm512_set1_ps(v);
+    }
+
+    static Int SetInt(int32_t v)
+    {
+        return _mm512_set1_epi32(v);
+    }
+
+    static Float Add(Float a, Float b)
+    {
+        return _mm512_add_ps(a, b);
+    }
+
+    static Int Add(Int a, Int b)
+    {
+        return _mm512_add_epi32(a, b);
+    }
+
+    static Float Sub(Float a, Float b)
+    {
+        return _mm512_sub_ps(a, b);
+    }
+
+    static Float Mul(Float a, Float b)
+    {
+        return _mm512_mul_ps(a, b);
+    }
+
+    static Float Min(Float a, Float b)
+    {
+        return _mm512_min_ps(a, b);
+    }
+
+    static Float Max(Float a, Float b)
+    {
+        return _mm512_max_ps(a, b);
+    }
+
+    static Float Floor(Float v)
+    {
+        return _mm512_roundscale_ps(v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    }
+
+    static Int ToInt(Float v)
+    {
+        return _mm512_cvttps_epi32(v);
+    }
+
+    static Int And(Int a, int32_t b)
+    {
+        return _mm512_and_si512(a, _mm512_set1_epi32(b));
+    }
+
+    static Mask Less(Int a, int32_t b)
+    {
+        return _mm512_cmplt_epi32_mask(a, _mm512_set1_epi32(b));
+    }
+
+    static Mask Equal(Int a, int32_t b)
+    {
+        return _mm512_cmpeq_epi32_mask(a, _mm512_set1_epi32(b));
+    }
+
+    static Mask Or(Mask a, Mask b)
+    {
+        return _kor_mask16(a, b);
+    }
+
+    static Float Select(Mask mask, Float a, Float b)
+    {
+        return _mm512_mask_blend_ps(mask, b, a);
+    }
+
+    // Plain AVX-512F has no float xor, flip the sign bit as int.
+    static Float Negate(Mask mask, Float v)
+    {
+        const Int bits = _mm512_castps_si512(v);
+        return _mm512_castsi512_ps(
+            _mm512_mask_xor_epi32(bits, mask, bits, _mm512_set1_epi32(INT32_MIN))
+        );
+    }
+
+    static Int Gather(const int32_t* table, Int index)
+    {
+        return _mm512_i32gather_epi32(index, table, 4);
+    }
+};
+} // namespace
+
+void NoiseKernelAvx512(const NoisePermutation& permutation, const NoiseBatch& batch)
+{
+    Octave2D01<Avx512Lanes>(permutation, batch);
+}
+} // namespace drive
+
+#endif
@@ -0,0 +1,223 @@
+#pragma once
+
+// Instruction set agnostic fBm kernel.
+// Included by NoiseKernel<Isa>.cpp after selecting the target, L wraps the intrinsics:
+//   Float, Int, Mask    lane types
+//   width               lanes per register
+//   Load, Store, Set    float memory and broadcast
+//   SetInt              int broadcast
+//   Add, Sub, Mul       float and int (Add only) arithmetic
+//   Min, Max            float
+//   Floor, ToInt        float -> float, float -> int (truncating)
+//   And                 int & scalar
+//   Less, Equal         int compared to scalar, returns Mask
+//   Or                  Mask | Mask
+//   Select              mask ? a : b
+//   Negate              mask ? -v : v
+//   Gather              table[index]
+// Operation order mirrors siv::PerlinNoise so results stay bit-identical without FMA.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "NoiseKernel.h"
+
+namespace drive
+{
+namespace
+{
+template<typename L>
+inline typename L::Float Fade(typename L::Float t)
+{
+    // t * t * t * (t * (t * 6 - 15) + 10)
+    const auto t3    = L::Mul(L::Mul(t, t), t);
+    const auto t6    = L::Sub(L::Mul(t, L::Set(6.0f)), L::Set(15.0f));
+    const auto inner = L::Add(L::Mul(t, t6), L::Set(10.0f));
+    return L::Mul(t3, inner);
+}
+
+template<typename L>
+inline typename L::Float Lerp(typename L::Float a, typename L::Float b, typename L::Float t)
+{
+    return L::Add(a, L::Mul(L::Sub(b, a), t));
+}
+
+template<typename L>
+inline typename L::Float Grad(
+    typename L::Int   hash,
+    typename L::Float x,
+    typename L::Float y,
+    typename L::Float z
+)
+{
+    const auto h  = L::And(hash, 15);
+    const auto u  = L::Select(L::Less(h, 8), x, y);
+    const auto xz = L::Select(L::Or(L::Equal(h, 12), L::Equal(h, 14)), x, z);
+    const auto v  = L::Select(L::Less(h, 4), y, xz);
+    const auto su = L::Negate(L::Equal(L::And(h, 1), 1), u);
+    const auto sv = L::Negate(L::Equal(L::And(h, 2), 2), v);
+    return L::Add(su, sv);
+}
+
+// noise2D is noise3D on a fixed z plane, so the z terms are constant.
+template<typename L>
+inline typename L::Float Noise2D(
+    const int32_t*    perm,
+    typename L::Float x,
+    typename L::Float y
+)
+{
+    const float fzScalar = static_cast<float>(SIVPERLIN_DEFAULT_Z);
+    const float wScalar  = fzScalar * fzScalar * fzScalar * (fzScalar * (fzScalar * 6 - 15) + 10);
+
+    const auto floorX = L::Floor(x);
+    const auto floorY = L::Floor(y);
+    const auto ix     = L::And(L::ToInt(floorX), 255);
+    const auto iy     = L::And(L::ToInt(floorY), 255);
+
+    const auto fx  = L::Sub(x, floorX);
+    const auto fy  = L::Sub(y, floorY);
+    const auto fz  = L::Set(fzScalar);
+    const auto fx1 = L::Sub(fx, L::Set(1.0f));
+    const auto fy1 = L::Sub(fy, L::Set(1.0f));
+    const auto fz1 = L::Set(fzScalar - 1);
+
+    const auto u = Fade<L>(fx);
+    const auto v = Fade<L>(fy);
+    const auto w = L::Set(wScalar);
+
+    // The doubled table makes the & 255 on these redundant.
+    const auto one = L::SetInt(1);
+    const auto A   = L::Add(L::Gather(perm, ix), iy);
+    const auto B   = L::Add(L::Gather(perm, L::Add(ix, one)), iy);
+    const auto AA  = L::Gather(perm, A);
+    const auto AB  = L::Gather(perm, L::Add(A, one));
+    const auto BA  = L::Gather(perm, B);
+    const auto BB  = L::Gather(perm, L::Add(B, one));
+
+    const auto aaa = Grad<L>(L::Gather(perm, AA), fx, fy, fz);
+    const auto baa = Grad<L>(L::Gather(perm, BA), fx1, fy, fz);
+    const auto aba = Grad<L>(L::Gather(perm, AB), fx, fy1, fz);
+    const auto bba = Grad<L>(L::Gather(perm, BB), fx1, fy1, fz);
+    const auto aab = Grad<L>(L::Gather(perm, L::Add(AA, one)), fx, fy, fz1);
+    const auto bab = Grad<L>(L::Gather(perm, L::Add(BA, one)), fx1, fy, fz1);
+    const auto abb = Grad<L>(L::Gather(perm, L::Add(AB, one)), fx, fy1, fz1);
+    const auto bbb = Grad<L>(L::Gather(perm, L::Add(BB, one)), fx1, fy1, fz1);
+
+    return Lerp<L>(
+        Lerp<L>(Lerp<L>(aaa, baa, u), Lerp<L>(aba, bba, u), v),
+        Lerp<L>(Lerp<L>(aab, bab, u), Lerp<L>(abb, bbb, u), v),
+        w
+    );
+}
+
+template<typename L>
+inline typename L::Float RemapClamp01(typename L::Float x)
+{
+    const auto remapped = L::Add(L::Mul(x, L::Set(0.5f)), L::Set(0.5f));
+    return L::Max(L::Min(remapped, L::Set(1.0f)), L::Set(0.0f));
+}
+
+// One register worth of samples.
+template<typename L>
+inline void Octave2D01Lanes(
+    const int32_t* perm,
+    const float*   xs,
+    const float*   ys,
+    int            octaves,
+    float*         out,
+    int            partialOctaves,
+    float*         partialOut,
+    int            firstOctave,
+    bool           raw
+)
+{
+    auto x = L::Load(xs);
+    auto y = L::Load(ys);
+
+    auto  result    = L::Set(0.0f);
+    float amplitude = 1.0f;
+
+    for (int i = 0; i < octaves; i++)
+    {
+        // Skipped octaves still advance frequency and amplitude, doubling is exact.
+        if (i >= firstOctave)
+        {
+            result = L::Add(result, L::Mul(Noise2D<L>(perm, x, y), L::Set(amplitude)));
+        }
+        x         = L::Mul(x, L::Set(2.0f));
+        y         = L::Mul(y, L::Set(2.0f));
+        amplitude *= 0.5f;
+
+        if (partialOut != nullptr && i + 1 == partialOctaves)
+        {
+            L::Store(partialOut, raw ? result : RemapClamp01<L>(result));
+        }
+    }
+
+    L::Store(out, raw ? result : RemapClamp01<L>(result));
+}
+
+template<typename L>
+void Octave2D01(const NoisePermutation& permutation, const NoiseBatch& batch)
+{
+    const int32_t* perm  = permutation.data();
+    const size_t   width = L::width;
+
+    size_t i = 0;
+    for (; i + width <= batch.count; i += width)
+    {
+        Octave2D01Lanes<L>(
+            perm,
+            batch.x + i,
+            batch.y + i,
+            batch.octaves,
+            batch.out + i,
+            batch.partialOctaves,
+            batch.partialOut != nullptr ? batch.partialOut + i : nullptr,
+            batch.firstOctave,
+            batch.raw
+        );
+    }
+
+    if (i == batch.count)
+    {
+        return;
+    }
+
+    // Pad the remainder to a full register.
+    float        tailX[L::width]       = {};
+    float        tailY[L::width]       = {};
+    float        tailOut[L::width]     = {};
+    float        tailPartial[L::width] = {};
+    const size_t tail                  = batch.count - i;
+
+    for (size_t j = 0; j < tail; j++)
+    {
+        tailX[j] = batch.x[i + j];
+        tailY[j] = batch.y[i + j];
+    }
+
+    Octave2D01Lanes<L>(
+        perm,
+        tailX,
+        tailY,
+        batch.octaves,
+        tailOut,
+        batch.partialOctaves,
+        batch.partialOut != nullptr ? tailPartial : nullptr,
+        batch.firstOctave,
+        batch.raw
+    );
+
+    for (size_t j = 0; j < tail; j++)
+    {
+        batch.out[i + j] = tailOut[j];
+        if (batch.partialOut != nullptr)
+        {
+            batch.partialOut[i + j] = tailPartial[j];
+        }
+    }
+}
+} // namespace
+} // namespace drive
@@ -0,0 +1,135 @@
+#include <cstddef>
+#include <cstdint>
+
+#include "NoiseKernel.h"
+
+#if __x86_64__ || _M_X64
+
+// SSE2 is part of the x86-64 baseline, no target switch needed.
+#include <emmintrin.h>
+
+#include "NoiseKernelImpl.h"
+
+namespace drive
+{
+namespace
+{
+struct Sse2Lanes
+{
+    using Float = __m128;
+    using Int   = __m128i;
+    using Mask  = __m128i;
+
+    static constexpr size_t width = 4;
+
+    static Float Load(const float* p)
+    {
+        return _mm_loadu_ps(p);
+    }
+
+    static void Store(float* p, Float v)
+    {
+        _mm_storeu_ps(p, v);
+    }
+
+    static Float Set(float v)
+    {
+        return _mm_set1_ps(v);
+    }
+
+    static Int SetInt(int32_t v)
+    {
+        return _mm_set1_epi32(v);
+    }
+
+    static Float Add(Float a, Float b)
+    {
+        return _mm_add_ps(a, b);
+    }
+
+    static Int Add(Int a, Int b)
+    {
+        return _mm_add_epi32(a, b);
+    }
+
+    static Float Sub(Float a, Float b)
+    {
+        return _mm_sub_ps(a, b);
+    }
+
+    static Float Mul(Float a, Float b)
+    {
+        return _mm_mul_ps(a, b);
+    }
+
+    static Float Min(Float a, Float b)
+    {
+        return _mm_min_ps(a, b);
+    }
+
+    static Float Max(Float a, Float b)
+    {
+        return _mm_max_ps(a, b);
+    }
+
+    // No roundps before SSE4.1, truncate and step down for negatives.
+    static Float Floor(Float v)
+    {
+        const Float truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+        const Float step      = _mm_and_ps(_mm_cmpgt_ps(truncated, v), _mm_set1_ps(1.0f));
+        return _mm_sub_ps(truncated, step);
+    }
+
+    static Int ToInt(Float v)
+    {
+        return _mm_cvttps_epi32(v);
+    }
+
+    static Int And(Int a, int32_t b)
+    {
+        return _mm_and_si128(a, _mm_set1_epi32(b));
+    }
+
+    static Mask Less(Int a, int32_t b)
+    {
+        return _mm_cmplt_epi32(a, _mm_set1_epi32(b));
+    }
+
+    static Mask Equal(Int a, int32_t b)
+    {
+        return _mm_cmpeq_epi32(a, _mm_set1_epi32(b));
+    }
+
+    static Mask Or(Mask a, Mask b)
+    {
+        return _mm_or_si128(a, b);
+    }
+
+    static Float Select(Mask mask, Float a, Float b)
+    {
+        const Float m = _mm_castsi128_ps(mask);
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+
+    static Float Negate(Mask mask, Float v)
+    {
+        const Float sign = _mm_and_ps(_mm_castsi128_ps(mask), _mm_set1_ps(-0.0f));
+        return _mm_xor_ps(v, sign);
+    }
+
+    static Int Gather(const int32_t* table, Int index)
+    {
+        alignas(16) int32_t i[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(i), index);
+        return _mm_setr_epi32(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+    }
+};
+} // namespace
+
+void NoiseKernelSse2(const NoisePermutation& permutation, const NoiseBatch& batch)
+{
+    Octave2D01<Sse2Lanes>(permutation, batch);
+}
+} // namespace drive
+
+#endif
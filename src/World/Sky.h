@@ -5,6 +5,7 @@
 #include "../Components/Camera.h"
 #include "../Renderer/Buffer.h"
 #include "../Renderer/DataTypes.h"
+#include "../Renderer/RenderQueue.h"
 #include "../Renderer/Renderer.h"
 #include "Icosphere.h"
 
@@ -16,10 +17,11 @@ struct Sky
     std::shared_ptr<Buffer>   indexBuffer;
     std::shared_ptr<Renderer> renderer;
 
-    Sky(std::shared_ptr<Renderer> rend)
+    // Sky sits just inside the camera far plane.
+    Sky(std::shared_ptr<Renderer> rend, float farPlane)
     {
         renderer       = rend;
-        auto icosphere = Icosphere({}, CAM_FAR * 0.95f, 1, true);
+        auto icosphere = Icosphere({}, farPlane * 0.95f, 1, true);
 
         std::vector<Vertex_P> vertices;
         vertices.reserve(icosphere.positions.size());
@@ -44,10 +46,13 @@ struct Sky
         );
     }
 
-    void Render()
+    void Render(RenderQueue& queue)
     {
-        renderer->BindPipeline(RenderPipeline::SKY);
-        renderer->DrawWithBuffers(vertexBuffer, indexBuffer);
+        queue.Add({
+            .pipeline     = RenderPipeline::SKY,
+            .vertexBuffer = vertexBuffer,
+            .indexBuffer  = indexBuffer,
+        });
     }
 };
 } // namespace drive
@@ -1,252 +1,1695 @@
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <numbers>
 
+#include <glm/common.hpp>
 #include <glm/geometric.hpp>
 
 #include "../Log.h"
 #include "../Renderer/Renderer.h"
+#include "../Time.h"
 #include "../Renderer/Vulkan/VulkanRenderer.h"
 #include "Terrain.h"
 
 namespace drive
 {
 
-Terrain::Terrain(std::shared_ptr<Renderer> renderer) :
+Terrain::Terrain(
+    std::shared_ptr<Renderer>  renderer,
+    std::shared_ptr<JobSystem> jobSystem,
+    TerrainSettings            settings
+) :
+    m_settings(settings),
+    m_grid(settings.gridRadius),
     m_renderer(renderer),
+    m_jobSystem(jobSystem),
+    m_evictedChunks(settings.evictedBudgetMB * 1024 * 1024),
     m_perlinSeed(0xDEADBEEF),
-    m_perlin(m_perlinSeed)
+    m_perlin(m_perlinSeed),
+    m_noise(m_perlin)
 {
     LOG_DEBUG("Creating Terrain");
-    m_observerPosition = {};
-    LoadChunks();
+    m_observerWorldPosition = {};
+    m_observerVelocity      = {};
+    m_observerTime          = 0.0;
+    m_slicedRowTime         = 0.0;
+    m_coarseSpacing         = 0.0f;
+    m_heightfieldSize = m_settings.mode == TerrainMode::LOD ? LodNodeSize(0) : CHUNK_SIZE;
+
+    if (m_settings.generator == TerrainGenerator::GPU)
+    {
+        const auto& permutation = m_noise.GetPermutation();
+        if (!m_renderer->SetTerrainPermutation(permutation))
+        {
+            LOG_WARNING("Renderer can't generate terrain, using CPU");
+            m_settings.generator = TerrainGenerator::CPU;
+        }
+        else if (!ValidateGpuGenerator())
+        {
+            m_settings.generator = TerrainGenerator::CPU;
+        }
+    }
+
+    m_settings.coarseOctaves = std::clamp(m_settings.coarseOctaves, 0, TERRAIN_OCTAVES);
+    m_coarseSpacing          = CoarseSpacing();
+    if (m_coarseSpacing > 0.0f)
+    {
+        LOG_INFO(
+            "Interpolating {} terrain octaves from a {} m lattice",
+            m_settings.coarseOctaves,
+            m_coarseSpacing
+        );
+    }
+
+    if (m_settings.benchmark && m_settings.generator == TerrainGenerator::CPU)
+    {
+        BenchmarkHeightfields();
+    }
+
+    // GPU chunks have no CPU-side data to store.
+    if (m_settings.diskCache && m_settings.generator == TerrainGenerator::CPU)
+    {
+        m_chunkCache = std::make_unique<ChunkCache>(m_jobSystem, m_perlinSeed, GeneratorVersion());
+    }
+
+    CreateChunkPool();
+    CreateVertexSlots();
+
+    // LOD nodes are selected on the first observer update.
+    if (m_settings.mode == TerrainMode::GRID)
+    {
+        LoadChunks();
+    }
+}
+
+Terrain::~Terrain()
+{
+    LOG_DEBUG("Destroying Terrain");
+
+    // Jobs reference this, let them finish.
+    m_jobSystem->Wait(m_pendingJobs);
+}
+
+void Terrain::SetObserverPosition(glm::vec3 pos)
+{
+    m_chunkPool->Collect();
+    PublishChunks();
+
+    if (m_settings.mode == TerrainMode::LOD)
+    {
+        SelectLodNodes(pos);
+        return;
+    }
+
+    UpdateObserverVelocity(pos);
+
+    auto chunkPos = Chunk::WorldToChunk(glm::vec2(pos.x, pos.y));
+
+    if (m_grid.GetCenter() != chunkPos)
+    {
+        std::vector<std::shared_ptr<Chunk>> evicted;
+        m_grid.SetCenter(chunkPos, evicted);
+        m_gridChanged = true;
+        for (auto& chunk : evicted)
+        {
+            EvictChunk(std::move(chunk));
+        }
+
+        LoadChunks();
+    }
+
+    if (PrefetchEnabled())
+    {
+        PrefetchChunks();
+    }
+
+    // Published on the next tick.
+    if (m_settings.scheduling == TerrainScheduling::TIME_SLICED)
+    {
+        GenerateSlicedChunks();
+    }
+
+    if (m_gridChanged)
+    {
+        PublishGridChunks();
+    }
+}
+
+void Terrain::Render(const Camera& camera, RenderQueue& queue)
+{
+    const Frustum frustum(camera.proj * camera.view);
+
+    uint32_t rendered = 0;
+    uint32_t culled   = 0;
+    uint32_t queued   = 0;
+
+    // Every LOD level shares the node grid, so one skirted index buffer serves all of them.
+    const auto indexBuffer = m_settings.mode == TerrainMode::LOD
+                                 ? m_renderer->GetGridIndexBuffer(TERRAIN_LOD_QUADS_PER_SIDE, true)
+                                 : m_renderer->GetGridIndexBuffer(CHUNK_QUADS_PER_SIDE);
+
+    const auto renderVisible = [&](const std::shared_ptr<Chunk>& chunk) {
+        if (m_vertexSlots && QueueChunk(*chunk))
+        {
+            queued++;
+            return;
+        }
+        if (!IsChunkVisible(*chunk, frustum))
+        {
+            culled++;
+            return;
+        }
+        RenderChunk(chunk, indexBuffer, camera.transform.position, queue);
+        rendered++;
+    };
+
+    // Copies, the tick thread replaces and recycles chunks while this renders.
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    if (m_settings.mode == TerrainMode::LOD)
+    {
+        std::scoped_lock lock {m_lodSelectionMutex};
+        chunks = m_lodSelection;
+    }
+    else
+    {
+        std::scoped_lock lock {m_gridChunksMutex};
+        chunks = m_gridChunks;
+    }
+
+    for (const auto& chunk : chunks)
+    {
+        renderVisible(chunk);
+    }
+
+    // Everything in the slot buffer is culled and drawn in one go.
+    if (queued > 0)
+    {
+        const TerrainIndirectPushConstants constants {.heightScale = TERRAIN_HEIGHT_RANGE};
+        m_renderer->BindPipeline(RenderPipeline::TERRAIN_INDIRECT);
+        m_renderer->PushConstants(&constants, sizeof(constants));
+        m_renderer->DrawTerrain(m_vertexSlots->GetBuffer(), indexBuffer, frustum.GetPlanes());
+    }
+
+    m_renderedChunks.store(rendered, std::memory_order_relaxed);
+    m_culledChunks.store(culled, std::memory_order_relaxed);
+    m_queuedChunks.store(queued, std::memory_order_relaxed);
+}
+
+bool Terrain::IsChunkVisible(const Chunk& chunk, const Frustum& frustum) const
+{
+    const auto [min, max] = ChunkBounds(chunk);
+    return frustum.IsBoxVisible(min, max);
+}
+
+std::pair<glm::vec3, glm::vec3> Terrain::ChunkBounds(const Chunk& chunk)
+{
+    // Skirts hang below the lowest vertex.
+    return {
+        glm::vec3(chunk.worldPosition, chunk.minHeight - chunk.skirtDepth),
+        glm::vec3(chunk.worldPosition + chunk.size, chunk.maxHeight),
+    };
+}
+
+float Terrain::GetViewDistance() const
+{
+    // Corner of the loaded area, the observer may be anywhere in the center cell.
+    if (m_settings.mode == TerrainMode::LOD)
+    {
+        return std::numbers::sqrt2_v<float> * 2.0f * LodNodeSize(TERRAIN_LOD_LEVELS - 1);
+    }
+    const float halfSize = static_cast<float>((m_grid.GetRadius() + 1) * CHUNK_SIZE);
+    return std::numbers::sqrt2_v<float> * halfSize;
+}
+
+TerrainStats Terrain::GetStats() const
+{
+    return {
+        .evictedHits     = m_evictedChunks.GetHits(),
+        .evictedMisses   = m_evictedChunks.GetMisses(),
+        .evictedChunks   = m_evictedChunks.GetCount(),
+        .evictedBytes    = m_evictedChunks.GetBytes(),
+        .prefetchHits    = m_prefetchHits.load(std::memory_order_relaxed),
+        .prefetchMisses  = m_prefetchMisses.load(std::memory_order_relaxed),
+        .prefetchStaged  = m_prefetchStaged.load(std::memory_order_relaxed),
+        .slicedQueued    = m_slicedQueued.load(std::memory_order_relaxed),
+        .slicedTickMs    = m_slicedTickMs.load(std::memory_order_relaxed),
+        .slicedOverruns  = m_slicedOverruns.load(std::memory_order_relaxed),
+        .renderedChunks  = m_renderedChunks.load(std::memory_order_relaxed),
+        .culledChunks    = m_culledChunks.load(std::memory_order_relaxed),
+        .queuedChunks    = m_queuedChunks.load(std::memory_order_relaxed),
+        .poolChunks      = m_chunkPool->GetCount(),
+        .poolFree        = m_chunkPool->GetFree(),
+        .poolBytes       = m_chunkPool->GetBytes(),
+        .poolGrowths     = m_chunkPool->GetGrowths(),
+        .vertexSlots     = m_vertexSlots ? m_vertexSlots->GetSlotCount() : 0,
+        .vertexSlotsFree = m_vertexSlots ? m_vertexSlots->GetFree() : 0,
+    };
+}
+
+void Terrain::PrepareChunk(Chunk& chunk)
+{
+    if (chunk.vertexBuffer == nullptr && m_settings.generator == TerrainGenerator::GPU)
+    {
+        m_renderer->GenerateTerrain(chunk.vertexBuffer, GpuGenParams(chunk));
+    }
+    else if (chunk.vertexSlot == nullptr && chunk.vertexBuffer == nullptr)
+    {
+        UploadVertices(chunk);
+    }
+    else if (chunk.vertexSlot && !chunk.mappedVertices.empty())
+    {
+        // Generated in place, flushed with the frame.
+        chunk.mappedVertices = {};
+    }
+}
+
+bool Terrain::QueueChunk(Chunk& chunk)
+{
+    PrepareChunk(chunk);
+    if (chunk.vertexSlot == nullptr)
+    {
+        return false;
+    }
+
+    const auto [min, max] = ChunkBounds(chunk);
+    const TerrainDraw draw {
+        .origin          = chunk.worldPosition,
+        .spacing         = chunk.spacing,
+        .skirtDepth      = chunk.skirtDepth,
+        .boundsMin       = min,
+        .verticesPerSide = chunk.quadsPerSide + 1,
+        .boundsMax       = max,
+        .vertexOffset    = static_cast<int32_t>(chunk.vertexSlot->firstElement),
+    };
+    if (!m_renderer->AddTerrainDraw(draw))
+    {
+        return false;
+    }
+
+    // The slot may be reused once the chunk is gone, not before the frame is.
+    m_renderer->KeepForFrame(chunk.vertexSlot);
+    return true;
+}
+
+void Terrain::RenderChunk(
+    const std::shared_ptr<Chunk>&  chunk,
+    const std::shared_ptr<Buffer>& indexBuffer,
+    const glm::vec3&               eye,
+    RenderQueue&                   queue
+)
+{
+    PrepareChunk(*chunk);
+
+    if ((chunk->vertexSlot || chunk->vertexBuffer) && indexBuffer)
+    {
+        const TerrainPushConstants constants {
+            .origin          = chunk->worldPosition,
+            .spacing         = chunk->spacing,
+            .heightScale     = TERRAIN_HEIGHT_RANGE,
+            .verticesPerSide = chunk->quadsPerSide + 1,
+            .skirtDepth      = chunk->skirtDepth,
+        };
+
+        // Closest point of the bounds, zero with the camera inside.
+        const auto [min, max] = ChunkBounds(*chunk);
+
+        DrawPacket packet {
+            .pipeline    = RenderPipeline::TERRAIN,
+            .depth       = glm::distance(eye, glm::clamp(eye, min, max)),
+            .indexBuffer = indexBuffer,
+        };
+        packet.SetConstants(constants);
+
+        if (chunk->vertexSlot)
+        {
+            // The slot may be reused once the chunk is gone, not before the frame is.
+            packet.vertexBuffer = m_vertexSlots->GetBuffer();
+            packet.vertexOffset = static_cast<int32_t>(chunk->vertexSlot->firstElement);
+            packet.keepAlive    = chunk->vertexSlot;
+        }
+        else
+        {
+            packet.vertexBuffer = chunk->vertexBuffer;
+        }
+
+        queue.Add(std::move(packet));
+    }
+}
+
+// Into a free vertex slot, or a buffer of the chunk's own when they're all in use.
+void Terrain::UploadVertices(Chunk& chunk)
+{
+    std::shared_ptr<BufferSlot> slot;
+    if (m_vertexSlots)
+    {
+        slot = m_vertexSlots->Acquire();
+    }
+
+    if (chunk.mappedBuffer != nullptr)
+    {
+        if (slot)
+        {
+            m_renderer->CopyBuffer(
+                chunk.mappedBuffer,
+                m_vertexSlots->GetBuffer(),
+                slot->firstElement
+            );
+            chunk.vertexSlot = std::move(slot);
+        }
+        else
+        {
+            m_renderer->SubmitMappedBuffer(chunk.vertexBuffer, chunk.mappedBuffer);
+        }
+        chunk.mappedBuffer   = nullptr;
+        chunk.mappedVertices = {};
+        return;
+    }
+
+    if (slot)
+    {
+        m_renderer->WriteBuffer(
+            m_vertexSlots->GetBuffer(),
+            slot->firstElement,
+            chunk.vertices.data(),
+            static_cast<uint32_t>(chunk.vertices.size())
+        );
+        chunk.vertexSlot = std::move(slot);
+    }
+    else
+    {
+        m_renderer->CreateBuffer(
+            chunk.vertexBuffer,
+            VertexBuffer,
+            chunk.vertices.data(),
+            sizeof(Vertex_Terrain),
+            static_cast<uint32_t>(chunk.vertices.size())
+        );
+    }
+    m_chunkPool->ReleaseVertices(chunk.vertices);
+}
+
+void Terrain::LoadChunks()
+{
+    const auto center = m_grid.GetCenter();
+    const int  radius = m_grid.GetRadius();
+
+    for (int x = center.x - radius; x <= center.x + radius; x++)
+    {
+        for (int y = center.y - radius; y <= center.y + radius; y++)
+        {
+            if (m_grid.Get({x, y}) == nullptr)
+            {
+                ScheduleChunk({0, x, y});
+            }
+        }
+    }
+}
+
+void Terrain::ScheduleChunk(ChunkKey key)
+{
+    // Already being generated, will be placed once done.
+    if (m_pendingChunks.contains(key))
+    {
+        // A prefetch that didn't finish in time.
+        if (m_prefetchingChunks.erase(key) > 0)
+        {
+            m_prefetchMisses.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    if (auto staged = m_prefetchedChunks.extract(key))
+    {
+        m_prefetchHits.fetch_add(1, std::memory_order_relaxed);
+        m_prefetchStaged.store(m_prefetchedChunks.size(), std::memory_order_relaxed);
+        PlaceChunk(std::move(staged.mapped()));
+        return;
+    }
+
+    // Recently evicted, no need to generate it again.
+    if (auto evicted = m_evictedChunks.Take(key))
+    {
+        PlaceChunk(std::move(evicted));
+        return;
+    }
+
+    if (PrefetchEnabled())
+    {
+        m_prefetchMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    GenerateChunkAsync(key);
+}
+
+void Terrain::AddHeightfield(const std::shared_ptr<Chunk>& chunk)
+{
+    // Coarser LOD nodes and GPU chunks are left to the generator.
+    if (chunk->lod != 0 || chunk->heights.empty())
+    {
+        return;
+    }
+
+    std::unique_lock lock {m_heightfieldsMutex};
+    m_heightfields[{chunk->position.x, chunk->position.y}] = chunk;
+}
+
+void Terrain::RemoveHeightfield(const Chunk& chunk)
+{
+    std::unique_lock lock {m_heightfieldsMutex};
+
+    const auto heightfield = m_heightfields.find({chunk.position.x, chunk.position.y});
+    if (heightfield != m_heightfields.end() && heightfield->second.get() == &chunk)
+    {
+        m_heightfields.erase(heightfield);
+    }
+}
+
+void Terrain::QueryGround(
+    std::span<const glm::vec2> positions,
+    std::span<float>           heights,
+    std::span<glm::vec3>       normals
+) const
+{
+    std::vector<size_t> misses;
+    {
+        std::shared_lock lock {m_heightfieldsMutex};
+
+        // Queries tend to be clustered, only look up a chunk when it changes.
+        auto         chunkPos = glm::ivec2(std::numeric_limits<int>::min());
+        const Chunk* chunk    = nullptr;
+
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            const auto cell = glm::ivec2(glm::floor(positions[i] / m_heightfieldSize));
+            if (cell != chunkPos)
+            {
+                const auto heightfield = m_heightfields.find({cell.x, cell.y});
+                const bool found       = heightfield != m_heightfields.end();
+
+                chunkPos = cell;
+                chunk    = found ? heightfield->second.get() : nullptr;
+            }
+
+            if (chunk == nullptr)
+            {
+                misses.push_back(i);
+                continue;
+            }
+
+            glm::vec3* normal = normals.empty() ? nullptr : &normals[i];
+            SampleHeightfield(*chunk, positions[i], heights[i], normal);
+        }
+    }
+
+    if (!misses.empty())
+    {
+        GenerateGround(positions, misses, heights, normals);
+    }
+}
+
+void Terrain::SampleHeightfield(
+    const Chunk& chunk,
+    glm::vec2    pos,
+    float&       height,
+    glm::vec3*   normal
+) const
+{
+    const unsigned int verticesPerSide = chunk.quadsPerSide + 1;
+    const float        quads           = static_cast<float>(chunk.quadsPerSide);
+
+    const auto local = glm::clamp((pos - chunk.worldPosition) / chunk.spacing, 0.0f, quads);
+    const auto cell  = glm::min(glm::uvec2(local), glm::uvec2(chunk.quadsPerSide - 1));
+    const auto t     = local - glm::vec2(cell);
+
+    const unsigned int vertex = cell.x * verticesPerSide + cell.y;
+    const float        h00    = chunk.heights[vertex];
+    const float        h01    = chunk.heights[vertex + 1];
+    const float        h10    = chunk.heights[vertex + verticesPerSide];
+    const float        h11    = chunk.heights[vertex + verticesPerSide + 1];
+
+    height = std::lerp(std::lerp(h00, h10, t.x), std::lerp(h01, h11, t.x), t.y);
+
+    if (normal != nullptr)
+    {
+        // Gradient of the bilinear patch.
+        const float dx = std::lerp(h10 - h00, h11 - h01, t.y);
+        const float dy = std::lerp(h01 - h00, h11 - h10, t.x);
+        *normal        = glm::normalize(glm::vec3(-dx, -dy, chunk.spacing));
+    }
+}
+
+void Terrain::GenerateGround(
+    std::span<const glm::vec2> positions,
+    const std::vector<size_t>& indices,
+    std::span<float>           heights,
+    std::span<glm::vec3>       normals
+) const
+{
+    // Normals take central differences like HeightfieldNormal,
+    // the 4 neighbours follow the center sample of every position.
+    const size_t samplesPer = normals.empty() ? 1 : 5;
+    const float  spacing    = 1.0f / TERRAIN_CHUNK_RESOLUTION;
+
+    const glm::vec2 offsets[5] = {
+        {0.0f, 0.0f},
+        {spacing, 0.0f},
+        {-spacing, 0.0f},
+        {0.0f, spacing},
+        {0.0f, -spacing},
+    };
+
+    const size_t       count = indices.size() * samplesPer;
+    std::vector<float> sampleX(count);
+    std::vector<float> sampleY(count);
+    std::vector<float> sampleHeights(count);
+    std::vector<float> sampleRoad(count);
+
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        for (size_t s = 0; s < samplesPer; s++)
+        {
+            const auto noisePos = (positions[indices[i]] + offsets[s]) * TERRAIN_NOISE_SCALE;
+
+            sampleX[i * samplesPer + s] = noisePos.x;
+            sampleY[i * samplesPer + s] = noisePos.y;
+        }
+    }
+
+    TerrainHeights(sampleX.data(), sampleY.data(), count, sampleHeights.data(), sampleRoad.data());
+
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        const float* samples = sampleHeights.data() + i * samplesPer;
+
+        heights[indices[i]] = samples[0];
+
+        if (!normals.empty())
+        {
+            const float dx      = samples[1] - samples[2];
+            const float dy      = samples[3] - samples[4];
+            normals[indices[i]] = glm::normalize(glm::vec3(-dx, -dy, 2.0f * spacing));
+        }
+    }
+}
+
+// Sized for the chunks loaded at once plus the evicted budget, so the arena
+// only grows if prefetching or LOD selection outrun the estimate.
+void Terrain::CreateChunkPool()
+{
+    const bool   lod             = m_settings.mode == TerrainMode::LOD;
+    const bool   cpu             = m_settings.generator == TerrainGenerator::CPU;
+    const size_t quadsPerSide    = lod ? TERRAIN_LOD_QUADS_PER_SIDE : CHUNK_QUADS_PER_SIDE;
+    const size_t verticesPerSide = quadsPerSide + 1;
+    const size_t apronPerSide    = quadsPerSide + 3;
+    const size_t skirtVertices   = lod ? 4 * verticesPerSide : 0;
+    const size_t chunkVertices   = verticesPerSide * verticesPerSide + skirtVertices;
+
+    // GPU chunks have no CPU-side heights or vertices.
+    const size_t heightCount = cpu ? verticesPerSide * verticesPerSide : 0;
+    const size_t vertexCount = cpu ? chunkVertices : 0;
+    const size_t apronCount  = cpu ? apronPerSide * apronPerSide : 0;
+
+    size_t loaded = TERRAIN_POOL_LOD_NODES;
+    if (!lod)
+    {
+        const auto gridSize = static_cast<size_t>(m_grid.GetSize());
+        loaded              = gridSize * gridSize + TERRAIN_PREFETCH_MAX_PENDING;
+    }
+
+    // Evicted chunks are accounted as in EvictChunk.
+    const size_t chunkBytes = heightCount * sizeof(float) + chunkVertices * sizeof(Vertex_Terrain);
+    const size_t evicted    = m_settings.evictedBudgetMB * 1024 * 1024 / chunkBytes;
+
+    m_chunkPool =
+        std::make_unique<ChunkPool>(loaded + evicted, heightCount, vertexCount, apronCount);
+    LOG_INFO(
+        "Chunk pool of {} chunks, {} MB",
+        m_chunkPool->GetCount(),
+        m_chunkPool->GetBytes() / (1024 * 1024)
+    );
+}
+
+void Terrain::CreateVertexSlots()
+{
+    // GPU chunks are generated into buffers of their own.
+    if (m_settings.generator != TerrainGenerator::CPU)
+    {
+        return;
+    }
+
+    const bool     lod             = m_settings.mode == TerrainMode::LOD;
+    const uint32_t quadsPerSide    = lod ? TERRAIN_LOD_QUADS_PER_SIDE : CHUNK_QUADS_PER_SIDE;
+    const uint32_t verticesPerSide = quadsPerSide + 1;
+    const uint32_t skirtVertices   = lod ? 4 * verticesPerSide : 0;
+    const uint32_t slotVertices    = verticesPerSide * verticesPerSide + skirtVertices;
+
+    // One slot per pooled chunk, more chunks than that fall back to their own buffers.
+    const auto slotCount = static_cast<uint32_t>(m_chunkPool->GetCount());
+
+    std::shared_ptr<Buffer> buffer;
+    void*                   data = nullptr;
+    if (!m_renderer->CreateSlotBuffer(
+            buffer,
+            VertexBuffer,
+            sizeof(Vertex_Terrain),
+            slotVertices * slotCount,
+            &data
+        ))
+    {
+        return;
+    }
+
+    m_vertexSlots = std::make_shared<BufferSlots>(buffer, slotVertices, slotCount, data);
+    LOG_INFO(
+        "Terrain vertex buffer of {} slots, {} MB{}",
+        slotCount,
+        static_cast<size_t>(slotVertices) * slotCount * sizeof(Vertex_Terrain) / (1024 * 1024),
+        data != nullptr ? ", mapped" : ""
+    );
+}
+
+void Terrain::GenerateChunkAsync(ChunkKey key)
+{
+    m_pendingChunks.insert(key);
+
+    const auto [lod, x, y] = key;
+
+    std::shared_ptr<Chunk> chunk;
+    if (m_settings.mode == TerrainMode::LOD)
+    {
+        chunk = m_chunkPool->Acquire(
+            glm::ivec2(x, y),
+            TERRAIN_LOD_QUADS_PER_SIDE,
+            lod,
+            LodNodeSize(lod)
+        );
+    }
+    else
+    {
+        chunk = m_chunkPool->Acquire(glm::ivec2(x, y), CHUNK_QUADS_PER_SIDE, 0, CHUNK_SIZE);
+    }
+
+    // Vertices are generated on the render thread, see RenderChunk.
+    if (m_settings.generator == TerrainGenerator::GPU)
+    {
+        // Heights are unknown, bound by the whole range.
+        chunk->minHeight = 0.0f;
+        chunk->maxHeight = TERRAIN_HEIGHT_RANGE;
+
+        // No heights to measure the seam gap, assume the steepest slope.
+        // Across a coarser neighbour's 4 spacings the gap is at most slope * 2 spacings.
+        if (m_settings.mode == TerrainMode::LOD)
+        {
+            chunk->skirtDepth = (2.0f * TERRAIN_MAX_SLOPE + 1.0f) * chunk->spacing;
+        }
+
+        std::scoped_lock lock {m_generatedMutex};
+        m_generatedChunks.push_back(chunk);
+        return;
+    }
+
+    if (m_settings.scheduling == TerrainScheduling::TIME_SLICED)
+    {
+        m_slicedChunks.push_back({.chunk = chunk, .scratch = nullptr, .nextRow = 0});
+        m_slicedQueued.store(m_slicedChunks.size(), std::memory_order_relaxed);
+        return;
+    }
+
+    m_jobSystem->Schedule(
+        [this, chunk]() {
+            AllocateVertices(*chunk);
+            if (m_chunkCache == nullptr || !m_chunkCache->Load(*chunk))
+            {
+                auto       scratch  = m_chunkPool->AcquireScratch();
+                const auto vertices = GenerateChunk(chunk, *scratch);
+                if (m_chunkCache != nullptr)
+                {
+                    m_chunkCache->Store(*chunk, vertices);
+                }
+                m_chunkPool->ReleaseScratch(std::move(scratch));
+            }
+
+            std::scoped_lock lock {m_generatedMutex};
+            m_generatedChunks.push_back(chunk);
+        },
+        &m_pendingJobs
+    );
+}
+
+void Terrain::PublishChunks()
+{
+    std::vector<std::shared_ptr<Chunk>> generated;
+    {
+        std::scoped_lock lock {m_generatedMutex};
+        generated.swap(m_generatedChunks);
+    }
+
+    for (auto& chunk : generated)
+    {
+        m_pendingChunks.erase(chunk->Key());
+        PlaceChunk(std::move(chunk));
+    }
+}
+
+void Terrain::PublishGridChunks()
+{
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    chunks.reserve(m_grid.GetSlots().size());
+    for (const auto& chunk : m_grid.GetSlots())
+    {
+        if (chunk != nullptr)
+        {
+            chunks.push_back(chunk);
+        }
+    }
+
+    // The previous snapshot is released after the lock.
+    std::scoped_lock lock {m_gridChunksMutex};
+    m_gridChunks.swap(chunks);
+    m_gridChanged = false;
+}
+
+void Terrain::PlaceChunk(std::shared_ptr<Chunk> chunk)
+{
+    // Unwanted nodes are evicted on the next selection.
+    if (m_settings.mode == TerrainMode::LOD)
+    {
+        AddHeightfield(chunk);
+        m_lodNodes.emplace(chunk->Key(), std::move(chunk));
+        return;
+    }
+
+    // Prefetched ahead of the grid, or the observer moved on while the chunk was generating.
+    const bool prefetched = m_prefetchingChunks.erase(chunk->Key()) > 0;
+    if (!m_grid.Contains(chunk->position))
+    {
+        if (prefetched)
+        {
+            m_prefetchedChunks.emplace(chunk->Key(), std::move(chunk));
+            m_prefetchStaged.store(m_prefetchedChunks.size(), std::memory_order_relaxed);
+        }
+        else
+        {
+            EvictChunk(std::move(chunk));
+        }
+        return;
+    }
+
+    const auto placed = chunk;
+    m_gridChanged     = true;
+    if (m_grid.Set(std::move(chunk)))
+    {
+        AddHeightfield(placed);
+    }
 }
 
-Terrain::~Terrain()
+void Terrain::EvictChunk(std::shared_ptr<Chunk> chunk)
 {
-    LOG_DEBUG("Destroying Terrain");
+    if (chunk == nullptr)
+    {
+        return;
+    }
+
+    RemoveHeightfield(*chunk);
+
+    // Vertices are either still on the CPU or in the vertex buffer, not both.
+    // The render thread may be uploading them, so the count comes from the grid.
+    const size_t vertexCount = ChunkVertexCount(*chunk);
+    const size_t bytes =
+        chunk->heights.capacity() * sizeof(float) + vertexCount * sizeof(Vertex_Terrain);
+
+    m_evictedChunks.Insert(std::move(chunk), bytes);
 }
 
-void Terrain::SetObserverPosition(glm::vec3 pos)
+uint32_t Terrain::ChunkVertexCount(const Chunk& chunk) const
 {
-    auto chunkPos = Chunk::WorldToChunk(glm::vec2(pos.x, pos.y));
+    const uint32_t verticesPerSide = chunk.quadsPerSide + 1;
+    const uint32_t skirtVertices   = m_settings.mode == TerrainMode::LOD ? 4 * verticesPerSide : 0;
+    return verticesPerSide * verticesPerSide + skirtVertices;
+}
+
+// Straight into memory the GPU can read when the renderer supports it,
+// pooled CPU storage copied on upload otherwise.
+void Terrain::AllocateVertices(Chunk& chunk)
+{
+    const uint32_t vertexCount = ChunkVertexCount(chunk);
 
-    if (m_observerPosition == chunkPos)
+    // A mapped slot buffer is read by the GPU as is, no upload needed.
+    if (m_vertexSlots && m_vertexSlots->IsMapped())
     {
-        return;
+        auto slot = m_vertexSlots->Acquire();
+        if (slot)
+        {
+            chunk.mappedVertices = {static_cast<Vertex_Terrain*>(slot->mappedData), vertexCount};
+            chunk.vertexSlot     = std::move(slot);
+            return;
+        }
     }
 
-    auto delta         = m_observerPosition - chunkPos;
-    m_observerPosition = chunkPos;
+    void* data = nullptr;
+    if (m_renderer->CreateMappedBuffer(
+            chunk.mappedBuffer,
+            VertexBuffer,
+            sizeof(Vertex_Terrain),
+            vertexCount,
+            &data
+        ))
+    {
+        chunk.mappedVertices = {static_cast<Vertex_Terrain*>(data), vertexCount};
+        return;
+    }
 
-    MoveChunks(delta);
-    LoadChunks();
+    m_chunkPool->AcquireVertices(chunk.vertices);
 }
 
-void Terrain::Render()
+void Terrain::GenerateSlicedChunks()
 {
-    for (int x = 0; x < CHUNK_ARR_SIZE; x++)
+    const double start    = Time::Now();
+    const double deadline = start + static_cast<double>(m_settings.tickBudgetMs) / 1000.0;
+
+    // At least one step per tick, a row estimate above the budget would stall generation.
+    bool stepped = false;
+    while (!m_slicedChunks.empty() && (!stepped || Time::Now() + m_slicedRowTime <= deadline))
     {
-        for (int y = 0; y < CHUNK_ARR_SIZE; y++)
+        stepped = true;
+
+        auto&              sliced       = m_slicedChunks.front();
+        const unsigned int apronPerSide = sliced.chunk->quadsPerSide + 3;
+
+        if (sliced.nextRow == 0)
         {
-            auto chunk = m_loadedChunks[x][y];
+            AllocateVertices(*sliced.chunk);
+        }
 
-            if (chunk != nullptr)
+        bool done = false;
+        if (sliced.nextRow == 0 && m_chunkCache != nullptr && m_chunkCache->Load(*sliced.chunk))
+        {
+            done = true;
+        }
+        else
+        {
+            if (sliced.nextRow == 0)
             {
-                if (chunk->vertexBuffer == nullptr)
-                {
-                    m_renderer->CreateBuffer(
-                        chunk->vertexBuffer,
-                        VertexBuffer,
-                        chunk->vertices.data(),
-                        sizeof(Vertex_P_N_C),
-                        static_cast<uint32_t>(chunk->vertices.size())
-                    );
-                    m_renderer->CreateBuffer(
-                        chunk->indexBuffer,
-                        IndexBuffer,
-                        chunk->indices.data(),
-                        sizeof(Index),
-                        static_cast<uint32_t>(chunk->indices.size())
-                    );
-                    chunk->vertices.clear();
-                    chunk->indices.clear();
-                }
+                sliced.scratch = m_chunkPool->AcquireScratch();
+            }
 
-                if (chunk->vertexBuffer && chunk->indexBuffer)
+            const double rowStart = Time::Now();
+            GenerateHeightfield(
+                *sliced.chunk,
+                *sliced.scratch,
+                sliced.nextRow,
+                sliced.nextRow + 1,
+                CoarseStride(*sliced.chunk)
+            );
+            m_slicedRowTime = std::lerp(m_slicedRowTime, Time::Now() - rowStart, 0.1);
+            sliced.nextRow++;
+
+            // Finishing is linear in the vertex count, a fraction of the noise cost.
+            if (sliced.nextRow == apronPerSide)
+            {
+                const auto vertices = GenerateVertices(sliced.chunk, *sliced.scratch);
+                if (m_chunkCache != nullptr)
                 {
-                    m_renderer->BindPipeline(RenderPipeline::TERRAIN);
-                    m_renderer->DrawWithBuffers(chunk->vertexBuffer, chunk->indexBuffer);
+                    m_chunkCache->Store(*sliced.chunk, vertices);
                 }
+                m_chunkPool->ReleaseScratch(std::move(sliced.scratch));
+                done = true;
+            }
+        }
+
+        if (done)
+        {
+            {
+                std::scoped_lock lock {m_generatedMutex};
+                m_generatedChunks.push_back(std::move(sliced.chunk));
             }
+            m_slicedChunks.pop_front();
         }
     }
+
+    const double end = Time::Now();
+    m_slicedQueued.store(m_slicedChunks.size(), std::memory_order_relaxed);
+    m_slicedTickMs.store(static_cast<float>((end - start) * 1000.0), std::memory_order_relaxed);
+
+    if (end > deadline)
+    {
+        m_slicedOverruns.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARNING(
+            "Terrain generation ran over budget: {:.2f}ms / {:.2f}ms",
+            (end - start) * 1000.0,
+            m_settings.tickBudgetMs
+        );
+    }
+}
+
+bool Terrain::PrefetchEnabled() const
+{
+    // LOD nodes already reach far past the observer.
+    return m_settings.mode == TerrainMode::GRID && m_settings.prefetchSeconds > 0.0f;
+}
+
+void Terrain::UpdateObserverVelocity(glm::vec3 pos)
+{
+    const auto   position = glm::vec2(pos.x, pos.y);
+    const double now      = Time::Now();
+    const float  delta    = static_cast<float>(now - m_observerTime);
+
+    if (m_observerTime > 0.0 && delta > 0.0f)
+    {
+        const auto velocity = (position - m_observerWorldPosition) / delta;
+        m_observerVelocity  = glm::mix(m_observerVelocity, velocity, TERRAIN_VELOCITY_SMOOTHING);
+    }
+
+    m_observerWorldPosition = position;
+    m_observerTime          = now;
 }
 
-void Terrain::MoveChunks(glm::ivec2 delta)
+void Terrain::PrefetchChunks()
 {
-    if (delta.x >= CHUNK_ARR_SIZE || delta.x <= -CHUNK_ARR_SIZE || delta.y >= CHUNK_ARR_SIZE
-        || delta.y <= -CHUNK_ARR_SIZE)
+    const auto lookahead = m_observerVelocity * m_settings.prefetchSeconds;
+    const auto predicted = Chunk::WorldToChunk(m_observerWorldPosition + lookahead);
+
+    // Staged chunks the observer is no longer heading towards.
+    for (auto staged = m_prefetchedChunks.begin(); staged != m_prefetchedChunks.end();)
     {
-        for (int x = 0; x < CHUNK_ARR_SIZE; x++)
+        if (m_grid.Contains(staged->second->position, predicted))
         {
-            for (int y = 0; y < CHUNK_ARR_SIZE; y++)
-            {
-                m_loadedChunks[x][y].reset();
-            }
+            staged++;
+            continue;
         }
+
+        EvictChunk(std::move(staged->second));
+        staged = m_prefetchedChunks.erase(staged);
+    }
+    m_prefetchStaged.store(m_prefetchedChunks.size(), std::memory_order_relaxed);
+
+    const auto center = m_grid.GetCenter();
+    const int  radius = m_grid.GetRadius();
+    if (predicted == center)
+    {
         return;
     }
 
-    if (delta.y < 0)
+    // Chunks of the predicted grid that are not in the current one, nearest first.
+    std::vector<glm::ivec2> candidates;
+    for (int x = -radius; x <= radius; x++)
     {
-        for (int x = 0; x < CHUNK_ARR_SIZE; x++)
+        for (int y = -radius; y <= radius; y++)
         {
-            for (int y = -delta.y; y < CHUNK_ARR_SIZE; y++)
+            const auto position = predicted + glm::ivec2(x, y);
+            if (!m_grid.Contains(position))
             {
-                m_loadedChunks[x][y + delta.y] = std::move(m_loadedChunks[x][y]);
+                candidates.push_back(position);
             }
         }
     }
-    else if (delta.y > 0)
+
+    const auto distance = [center](glm::ivec2 position) {
+        const auto offset = glm::abs(position - center);
+        return std::max(offset.x, offset.y);
+    };
+    std::ranges::sort(candidates, [&distance](glm::ivec2 a, glm::ivec2 b) {
+        return distance(a) < distance(b);
+    });
+
+    for (const auto& position : candidates)
     {
-        for (int x = 0; x < CHUNK_ARR_SIZE; x++)
+        if (m_prefetchingChunks.size() >= TERRAIN_PREFETCH_MAX_PENDING)
         {
-            for (int y = CHUNK_ARR_SIZE - 1; y >= delta.y; y--)
-            {
-                m_loadedChunks[x][y] = std::move(m_loadedChunks[x][y - delta.y]);
-            }
+            break;
         }
+        PrefetchChunk({0, position.x, position.y});
+    }
+}
+
+void Terrain::PrefetchChunk(ChunkKey key)
+{
+    if (m_pendingChunks.contains(key) || m_prefetchedChunks.contains(key))
+    {
+        return;
+    }
+
+    if (auto evicted = m_evictedChunks.Take(key))
+    {
+        m_prefetchedChunks.emplace(key, std::move(evicted));
+        m_prefetchStaged.store(m_prefetchedChunks.size(), std::memory_order_relaxed);
+        return;
     }
 
-    if (delta.x < 0)
+    m_prefetchingChunks.insert(key);
+    GenerateChunkAsync(key);
+}
+
+void Terrain::SelectLodNodes(glm::vec3 pos)
+{
+    const int   rootLod  = TERRAIN_LOD_LEVELS - 1;
+    const float rootSize = LodNodeSize(rootLod);
+    const int   rootX    = static_cast<int>(std::floor(pos.x / rootSize));
+    const int   rootY    = static_cast<int>(std::floor(pos.y / rootSize));
+
+    std::vector<std::shared_ptr<Chunk>> selection;
+    std::set<ChunkKey>                  keep;
+
+    // 3x3 roots keep at least one root size of terrain around the observer.
+    for (int x = rootX - 1; x <= rootX + 1; x++)
     {
-        for (int x = -delta.x; x < CHUNK_ARR_SIZE; x++)
+        for (int y = rootY - 1; y <= rootY + 1; y++)
         {
-            for (int y = 0; y < CHUNK_ARR_SIZE; y++)
-            {
-                m_loadedChunks[x + delta.x][y] = std::move(m_loadedChunks[x][y]);
-            }
+            SelectLodNode(pos, {rootLod, x, y}, selection, keep);
         }
     }
-    else if (delta.x > 0)
+
+    for (auto node = m_lodNodes.begin(); node != m_lodNodes.end();)
     {
-        for (int x = CHUNK_ARR_SIZE - 1; x >= delta.x; x--)
+        if (keep.contains(node->first))
         {
-            for (int y = 0; y < CHUNK_ARR_SIZE; y++)
-            {
-                m_loadedChunks[x][y] = std::move(m_loadedChunks[x - delta.x][y]);
-            }
+            node++;
+            continue;
         }
+
+        EvictChunk(std::move(node->second));
+        node = m_lodNodes.erase(node);
     }
+
+    std::scoped_lock lock {m_lodSelectionMutex};
+    m_lodSelection.swap(selection);
 }
 
-// TODO: thread pool
-void Terrain::LoadChunks()
+void Terrain::SelectLodNode(
+    glm::vec3                            pos,
+    ChunkKey                             key,
+    std::vector<std::shared_ptr<Chunk>>& selection,
+    std::set<ChunkKey>&                  keep
+)
 {
-    for (int x = 0; x < CHUNK_ARR_SIZE; x++)
+    keep.insert(key);
+
+    auto node = m_lodNodes.find(key);
+    if (node == m_lodNodes.end())
+    {
+        // Evicted nodes are placed right away.
+        ScheduleChunk(key);
+        node = m_lodNodes.find(key);
+        if (node == m_lodNodes.end())
+        {
+            return;
+        }
+    }
+
+    const auto [lod, x, y] = key;
+    const auto& chunk      = *node->second;
+
+    // Distance to the node bounds, heights may span the whole range.
+    const auto boundsMin = glm::vec3(chunk.worldPosition, 0.0f);
+    const auto boundsMax = glm::vec3(chunk.worldPosition + chunk.size, TERRAIN_HEIGHT_RANGE);
+    const auto outside   = glm::max(glm::max(boundsMin - pos, pos - boundsMax), glm::vec3(0.0f));
+
+    if (lod > 0 && glm::length(outside) < chunk.size * TERRAIN_LOD_SPLIT_DISTANCE)
     {
-        for (int y = 0; y < CHUNK_ARR_SIZE; y++)
+        // Children replace the node once all four are generated,
+        // until then the node keeps covering their area without holes.
+        ChunkKey children[4];
+        bool     ready = true;
+        for (int i = 0; i < 4; i++)
         {
-            if (m_loadedChunks[x][y] == nullptr)
+            children[i] = {lod - 1, 2 * x + i / 2, 2 * y + i % 2};
+            keep.insert(children[i]);
+
+            if (!m_lodNodes.contains(children[i]))
+            {
+                ScheduleChunk(children[i]);
+                ready = ready && m_lodNodes.contains(children[i]);
+            }
+        }
+
+        if (ready)
+        {
+            for (const auto& child : children)
             {
-                auto chunk = std::make_shared<Chunk>(
-                    glm::ivec2(x, y) + m_observerPosition - glm::ivec2(TERRAIN_DISTANCE)
-                );
-                GenerateChunk(chunk);
-                m_loadedChunks[x][y] = chunk;
+                SelectLodNode(pos, child, selection, keep);
             }
+            return;
+        }
+    }
+
+    selection.push_back(node->second);
+}
+
+float Terrain::LodNodeSize(int lod)
+{
+    return static_cast<float>(TERRAIN_LOD_NODE_SIZE << lod);
+}
+
+TerrainGenPushConstants Terrain::GpuGenParams(const Chunk& chunk) const
+{
+    return {
+        .origin          = chunk.worldPosition,
+        .spacing         = chunk.spacing,
+        .verticesPerSide = chunk.quadsPerSide + 1,
+        .noiseScale      = TERRAIN_NOISE_SCALE,
+        .terrainHeight   = TERRAIN_HEIGHT,
+        .roadHeight      = ROAD_HEIGHT,
+        .roadThreshold   = ROAD_NOISE_THRESHOLD,
+        .heightScale     = TERRAIN_HEIGHT_RANGE,
+        .skirts          = m_settings.mode == TerrainMode::LOD ? 1u : 0u,
+    };
+}
+
+// Generates a chunk on both the CPU and GPU and compares the vertices.
+bool Terrain::ValidateGpuGenerator()
+{
+    // Crosses the road so every material is covered.
+    const unsigned int apronPerSide = CHUNK_QUADS_PER_SIDE + 3;
+
+    auto         chunk = std::make_shared<Chunk>(glm::ivec2(1, 0), CHUNK_QUADS_PER_SIDE);
+    ChunkScratch scratch {
+        .heightfield = std::vector<float>(apronPerSide * apronPerSide),
+        .road        = std::vector<float>(apronPerSide * apronPerSide),
+    };
+    GenerateChunk(chunk, scratch);
+
+    std::vector<Vertex_Terrain> gpuVertices;
+    if (!m_renderer->ReadTerrain(GpuGenParams(*chunk), gpuVertices))
+    {
+        LOG_WARNING("Failed to read back GPU terrain, using CPU");
+        return false;
+    }
+
+    if (gpuVertices.size() != chunk->vertices.size())
+    {
+        LOG_WARNING("GPU terrain vertex count differs from CPU, using CPU");
+        return false;
+    }
+
+    float    heightError       = 0.0f;
+    float    normalError       = 0.0f;
+    uint32_t materialMismatch  = 0;
+    for (size_t i = 0; i < gpuVertices.size(); i++)
+    {
+        const auto& cpu = chunk->vertices[i];
+        const auto& gpu = gpuVertices[i];
+
+        const float heightDelta = static_cast<float>(std::abs(cpu.height - gpu.height));
+        heightError = std::max(heightError, heightDelta / 65535.0f * TERRAIN_HEIGHT_RANGE);
+
+        for (int c = 0; c < 2; c++)
+        {
+            const float normalDelta = static_cast<float>(std::abs(cpu.normal[c] - gpu.normal[c]));
+            normalError             = std::max(normalError, normalDelta / 32767.0f);
+        }
+
+        // Road thresholds may flip on either side, those vertices are still close in height.
+        if (cpu.material != gpu.material)
+        {
+            materialMismatch++;
+        }
+    }
+
+    if (heightError > TERRAIN_GPU_HEIGHT_TOLERANCE || normalError > TERRAIN_GPU_NORMAL_TOLERANCE)
+    {
+        LOG_WARNING(
+            "GPU terrain differs from CPU by {} height, {} normal, using CPU",
+            heightError,
+            normalError
+        );
+        return false;
+    }
+
+    LOG_INFO(
+        "Using GPU terrain generation, max error {} height, {} normal, {} materials differ",
+        heightError,
+        normalError,
+        materialMismatch
+    );
+    return true;
+}
+
+// Lattice spacing keeping the bilinear interpolation error of the coarse octaves within
+// coarseMaxError. The error is at most h^2 / 8 * max(|f_xx| + |f_yy|), octave i adds
+// 2^-i * (2^i * TERRAIN_NOISE_SCALE)^2 * TERRAIN_NOISE_CURVATURE to that before scaling
+// to TERRAIN_HEIGHT / 2.
+float Terrain::CoarseSpacing() const
+{
+    if (m_settings.generator != TerrainGenerator::CPU || m_settings.coarseOctaves <= 0
+        || m_settings.coarseMaxError <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    float curvature = 0.0f;
+    for (int i = 0; i < m_settings.coarseOctaves; i++)
+    {
+        curvature += std::ldexp(1.0f, i);
+    }
+    curvature *= TERRAIN_NOISE_SCALE * TERRAIN_NOISE_SCALE * TERRAIN_NOISE_CURVATURE
+               * 0.5f * TERRAIN_HEIGHT;
+
+    return std::sqrt(8.0f * m_settings.coarseMaxError / curvature);
+}
+
+// 1 evaluates every octave per sample.
+unsigned int Terrain::CoarseStride(const Chunk& chunk) const
+{
+    if (m_coarseSpacing <= 0.0f)
+    {
+        return 1;
+    }
+
+    // The lattice starts at each chunk's corner, neighbours of the same spacing only
+    // share its nodes along their edge when the stride divides the chunk.
+    auto stride = std::max(static_cast<unsigned int>(m_coarseSpacing / chunk.spacing), 1u);
+    while (chunk.quadsPerSide % stride != 0)
+    {
+        stride--;
+    }
+    return stride;
+}
+
+// Multi-resolution heights depend on the lattice, cache them separately:
+// generator version in the low byte, then the split and the spacing in cm.
+uint32_t Terrain::GeneratorVersion() const
+{
+    if (m_coarseSpacing <= 0.0f)
+    {
+        return TERRAIN_GENERATOR_VERSION;
+    }
+
+    const auto spacing = static_cast<uint32_t>(m_coarseSpacing * 100.0f);
+    const auto split   = static_cast<uint32_t>(m_settings.coarseOctaves);
+    return TERRAIN_GENERATOR_VERSION | (split << 8) | (spacing << 16);
+}
+
+// Times full and multi-resolution heightfields of the same chunks and compares them.
+void Terrain::BenchmarkHeightfields()
+{
+    const unsigned int apronPerSide = CHUNK_QUADS_PER_SIDE + 3;
+    const size_t       sampleCount  = apronPerSide * apronPerSide;
+
+    ChunkScratch full {
+        .heightfield = std::vector<float>(sampleCount),
+        .road        = std::vector<float>(sampleCount),
+    };
+    ChunkScratch multires {
+        .heightfield = std::vector<float>(sampleCount),
+        .road        = std::vector<float>(sampleCount),
+    };
+
+    double       fullTime     = 0.0;
+    double       multiresTime = 0.0;
+    float        error        = 0.0f;
+    unsigned int stride       = 1;
+
+    for (int i = 0; i < TERRAIN_BENCHMARK_CHUNKS; i++)
+    {
+        const Chunk chunk(glm::ivec2(i % 8 - 4, i / 8 - 4), CHUNK_QUADS_PER_SIDE);
+        stride = CoarseStride(chunk);
+
+        double start = Time::Now();
+        GenerateHeightfield(chunk, full, 0, apronPerSide, 1);
+        fullTime += Time::Now() - start;
+
+        start = Time::Now();
+        GenerateHeightfield(chunk, multires, 0, apronPerSide, stride);
+        multiresTime += Time::Now() - start;
+
+        for (size_t s = 0; s < sampleCount; s++)
+        {
+            error = std::max(error, std::abs(multires.heightfield[s] - full.heightfield[s]));
         }
     }
+
+    const double chunks = TERRAIN_BENCHMARK_CHUNKS;
+    LOG_INFO(
+        "Heightfield benchmark: full {:.3f} ms, multi-resolution {:.3f} ms per chunk ({:.2f}x), "
+        "stride {}, max error {} (bound {})",
+        fullTime / chunks * 1000.0,
+        multiresTime / chunks * 1000.0,
+        multiresTime > 0.0 ? fullTime / multiresTime : 0.0,
+        stride,
+        error,
+        m_settings.coarseMaxError
+    );
+}
+
+std::span<const Vertex_Terrain> Terrain::GenerateChunk(
+    std::shared_ptr<Chunk> chunk,
+    ChunkScratch&          scratch
+)
+{
+    const unsigned int apronPerSide = chunk->quadsPerSide + 3;
+
+    GenerateHeightfield(*chunk, scratch, 0, apronPerSide, CoarseStride(*chunk));
+    return GenerateVertices(chunk, scratch);
 }
 
-void Terrain::GenerateChunk(std::shared_ptr<Chunk> chunk)
+std::span<const Vertex_Terrain> Terrain::GenerateVertices(
+    std::shared_ptr<Chunk> chunk,
+    ChunkScratch&          scratch
+)
 {
-    const unsigned int quadsPerSide    = (CHUNK_SIZE * TERRAIN_CHUNK_RESOLUTION);
-    const unsigned int verticesPerSide = quadsPerSide + 1;
+    const unsigned int verticesPerSide = chunk->quadsPerSide + 1;
+    const unsigned int apronPerSide    = verticesPerSide + 2;
     const unsigned int verticesCount   = verticesPerSide * verticesPerSide;
-    const unsigned int indicesCount    = quadsPerSide * quadsPerSide * 6;
+    const auto&        heightfield     = scratch.heightfield;
+    const auto&        road            = scratch.road;
 
-    chunk->vertices = std::vector<Vertex_P_N_C>(verticesCount);
-    chunk->indices  = std::vector<Index>(indicesCount);
+    // Mapped buffers may be write-combined memory, reading them back is slow.
+    // Pooled chunks and scratch already have the capacity.
+    const bool mapped = !chunk->mappedVertices.empty();
+    auto&      target = mapped ? scratch.vertices : chunk->vertices;
+    target.resize(ChunkVertexCount(*chunk));
+    chunk->heights.resize(verticesCount);
 
+    const std::span<Vertex_Terrain> vertices(target);
     for (unsigned int x = 0; x < verticesPerSide; x++)
     {
-        const float xOffset = static_cast<float>(x) / TERRAIN_CHUNK_RESOLUTION;
-
         for (unsigned int y = 0; y < verticesPerSide; y++)
         {
-            const float     yOffset     = static_cast<float>(y) / TERRAIN_CHUNK_RESOLUTION;
-            const glm::vec2 vertexWorld = chunk->worldPosition + glm::vec2(xOffset, yOffset);
+            const unsigned int center = (x + 1) * apronPerSide + (y + 1);
+            const unsigned int index  = x * verticesPerSide + y;
+            const float        height = heightfield[center];
+
+            // x/y are implicit in the vertex index, only height is stored.
+            Vertex_Terrain vertex;
+            vertex.SetNormal(HeightfieldNormal(*chunk, heightfield, center));
+            vertex.height   = Vertex_Terrain::PackUnorm(height / TERRAIN_HEIGHT_RANGE);
+            vertex.material = RoadMaterial(road[center]);
+
+            chunk->heights[index] = height;
+            vertices[index]       = vertex;
+        }
+    }
+    chunk->UpdateHeightBounds();
+
+    if (m_settings.mode == TerrainMode::LOD)
+    {
+        GenerateSkirts(*chunk, vertices);
+    }
+
+    if (mapped)
+    {
+        std::memcpy(chunk->mappedVertices.data(), vertices.data(), vertices.size_bytes());
+    }
+    return vertices;
+}
+
+void Terrain::GenerateHeightfield(
+    const Chunk&  chunk,
+    ChunkScratch& scratch,
+    unsigned int  firstRow,
+    unsigned int  endRow,
+    unsigned int  coarseStride
+)
+{
+    if (coarseStride > 1)
+    {
+        GenerateMultiresHeightfield(chunk, scratch, firstRow, endRow, coarseStride);
+        return;
+    }
+
+    const unsigned int apronPerSide = chunk.quadsPerSide + 3;
+
+    auto& sampleX = scratch.sampleX;
+    auto& sampleY = scratch.sampleY;
+    sampleX.resize(apronPerSide);
+    sampleY.resize(apronPerSide);
+
+    // Noise is evaluated a row at a time, straight into the grid.
+    for (unsigned int x = firstRow; x < endRow; x++)
+    {
+        const float xOffset = (static_cast<float>(x) - 1.0f) * chunk.spacing;
+
+        for (unsigned int y = 0; y < apronPerSide; y++)
+        {
+            const float yOffset  = (static_cast<float>(y) - 1.0f) * chunk.spacing;
+            const auto  noisePos = (chunk.worldPosition + glm::vec2(xOffset, yOffset))
+                                 * TERRAIN_NOISE_SCALE;
+
+            sampleX[y] = noisePos.x;
+            sampleY[y] = noisePos.y;
+        }
+
+        const unsigned int row = x * apronPerSide;
+        TerrainHeights(
+            sampleX.data(),
+            sampleY.data(),
+            apronPerSide,
+            scratch.heightfield.data() + row,
+            scratch.road.data() + row
+        );
+    }
+}
+
+// Raw fBm sums of the coarse octaves on a lattice covering the rows, bilinearly interpolated
+// and added to the sums of the remaining octaves evaluated per sample.
+// Road terrain is split the same way at TERRAIN_ROAD_OCTAVES.
+void Terrain::GenerateMultiresHeightfield(
+    const Chunk&  chunk,
+    ChunkScratch& scratch,
+    unsigned int  firstRow,
+    unsigned int  endRow,
+    unsigned int  coarseStride
+)
+{
+    const unsigned int apronPerSide = chunk.quadsPerSide + 3;
+    const int          split        = m_settings.coarseOctaves;
+
+    // Nodes at every coarseStride samples, plus one past the last sample.
+    const unsigned int nodesPerSide = (apronPerSide - 1) / coarseStride + 2;
+    const unsigned int firstNode    = firstRow / coarseStride;
+    const unsigned int endNode      = (endRow - 1) / coarseStride + 2;
+    const unsigned int nodeCount    = (endNode - firstNode) * nodesPerSide;
+    const float        nodeSpacing  = static_cast<float>(coarseStride) * chunk.spacing;
+    const float        stride       = static_cast<float>(coarseStride);
+
+    auto& heights       = scratch.heightfield;
+    auto& road          = scratch.road;
+    auto& nodeX         = scratch.nodeX;
+    auto& nodeY         = scratch.nodeY;
+    auto& coarseTerrain = scratch.coarseTerrain;
+    auto& coarseRoad    = scratch.coarseRoad;
+    auto& sampleX       = scratch.sampleX;
+    auto& sampleY       = scratch.sampleY;
+    auto& rowTerrain    = scratch.rowTerrain;
+    auto& rowRoad       = scratch.rowRoad;
+    nodeX.resize(nodeCount);
+    nodeY.resize(nodeCount);
+    coarseTerrain.resize(nodeCount);
+    coarseRoad.resize(nodeCount);
+    sampleX.resize(apronPerSide);
+    sampleY.resize(apronPerSide);
+    rowTerrain.resize(nodesPerSide);
+    rowRoad.resize(nodesPerSide);
+    for (unsigned int x = firstNode; x < endNode; x++)
+    {
+        for (unsigned int y = 0; y < nodesPerSide; y++)
+        {
+            const auto offset   = glm::vec2(static_cast<float>(x), static_cast<float>(y))
+                                * nodeSpacing
+                                - chunk.spacing;
+            const auto noisePos = (chunk.worldPosition + offset) * TERRAIN_NOISE_SCALE;
 
-            chunk->vertices[x * verticesPerSide + y] = GenerateTerrain(vertexWorld);
+            const unsigned int node = (x - firstNode) * nodesPerSide + y;
+            nodeX[node]             = noisePos.x;
+            nodeY[node]             = noisePos.y;
         }
     }
 
-    for (unsigned int x = 0; x < quadsPerSide; x++)
+    m_noise.Octave2D_01({
+        .x              = nodeX.data(),
+        .y              = nodeY.data(),
+        .count          = nodeCount,
+        .octaves        = split,
+        .out            = coarseTerrain.data(),
+        .partialOctaves = std::min(split, TERRAIN_ROAD_OCTAVES),
+        .partialOut     = coarseRoad.data(),
+        .raw            = true,
+    });
+
+    // std::lerp's exactness guarantees cost more than the skipped octaves save.
+    const auto lerp = [](float a, float b, float t) { return a + (b - a) * t; };
+
+    for (unsigned int x = firstRow; x < endRow; x++)
     {
-        for (unsigned int y = 0; y < quadsPerSide; y++)
+        const float xOffset = (static_cast<float>(x) - 1.0f) * chunk.spacing;
+
+        for (unsigned int y = 0; y < apronPerSide; y++)
+        {
+            const float yOffset  = (static_cast<float>(y) - 1.0f) * chunk.spacing;
+            const auto  noisePos = (chunk.worldPosition + glm::vec2(xOffset, yOffset))
+                                 * TERRAIN_NOISE_SCALE;
+
+            sampleX[y] = noisePos.x;
+            sampleY[y] = noisePos.y;
+        }
+
+        // Partial sums past the split are empty, leaving road terrain to the lattice.
+        const unsigned int row = x * apronPerSide;
+        m_noise.Octave2D_01({
+            .x              = sampleX.data(),
+            .y              = sampleY.data(),
+            .count          = apronPerSide,
+            .octaves        = TERRAIN_OCTAVES,
+            .out            = heights.data() + row,
+            .partialOctaves = TERRAIN_ROAD_OCTAVES,
+            .partialOut     = road.data() + row,
+            .firstOctave    = split,
+            .raw            = true,
+        });
+
+        // Lattice rows on either side of this one, interpolated once per row.
+        const unsigned int node0 = (x / coarseStride - firstNode) * nodesPerSide;
+        const unsigned int node1 = node0 + nodesPerSide;
+        const float        tx    = static_cast<float>(x % coarseStride) / stride;
+        for (unsigned int y = 0; y < nodesPerSide; y++)
         {
-            const unsigned int firstIndex  = (x * quadsPerSide + y) * 6;
-            const unsigned int firstVertex = x * verticesPerSide + y;
+            rowTerrain[y] = lerp(coarseTerrain[node0 + y], coarseTerrain[node1 + y], tx);
+            rowRoad[y]    = lerp(coarseRoad[node0 + y], coarseRoad[node1 + y], tx);
+        }
+
+        for (unsigned int y = 0; y < apronPerSide; y++)
+        {
+            const unsigned int node = y / coarseStride;
+            const float        ty   = static_cast<float>(y % coarseStride) / stride;
+
+            const float terrainSum = heights[row + y]
+                                   + lerp(rowTerrain[node], rowTerrain[node + 1], ty);
+            const float roadSum    = road[row + y] + lerp(rowRoad[node], rowRoad[node + 1], ty);
 
-            chunk->indices[firstIndex + 0] = {firstVertex + 0};
-            chunk->indices[firstIndex + 1] = {firstVertex + verticesPerSide};
-            chunk->indices[firstIndex + 2] = {firstVertex + 1};
+            // siv::PerlinNoise octave2D_01 remapping.
+            const float terrain     = std::clamp(terrainSum * 0.5f + 0.5f, 0.0f, 1.0f);
+            const float roadTerrain = std::clamp(roadSum * 0.5f + 0.5f, 0.0f, 1.0f);
 
-            chunk->indices[firstIndex + 3] = {firstVertex + 1};
-            chunk->indices[firstIndex + 4] = {firstVertex + verticesPerSide};
-            chunk->indices[firstIndex + 5] = {firstVertex + verticesPerSide + 1};
+            road[row + y]    = RoadNoise(glm::vec2(sampleX[y], sampleY[y]));
+            heights[row + y] = TerrainHeight(terrain, roadTerrain, road[row + y]);
         }
     }
 }
 
-Vertex_P_N_C Terrain::GenerateTerrain(glm::vec2 worldPos)
+glm::vec3 Terrain::HeightfieldNormal(
+    const Chunk&              chunk,
+    const std::vector<float>& heights,
+    unsigned int              center
+)
 {
-    const auto  noisePos     = worldPos * TERRAIN_NOISE_SCALE;
-    const float vertexHeight = TerrainHeight(noisePos);
-    const auto  pos          = glm::vec3(worldPos.x, worldPos.y, vertexHeight);
+    const unsigned int apronPerSide = chunk.quadsPerSide + 3;
 
-    // Figure out the vertex normal by sampling noise from 2 more spots
-    const float noiseNormalOffset = 0.5f * TERRAIN_NOISE_SCALE;
-    const auto  xPos              = glm::vec2(noisePos.x + noiseNormalOffset, noisePos.y);
-    const auto  yPos              = glm::vec2(noisePos.x, noisePos.y + noiseNormalOffset);
-    const float heightX           = TerrainHeight(xPos);
-    const float heightY           = TerrainHeight(yPos);
-    const auto  vX = glm::vec3(xPos.x / TERRAIN_NOISE_SCALE, xPos.y / TERRAIN_NOISE_SCALE, heightX);
-    const auto  vY = glm::vec3(yPos.x / TERRAIN_NOISE_SCALE, yPos.y / TERRAIN_NOISE_SCALE, heightY);
-    const auto  tangent   = vX - pos;
-    const auto  bitangent = vY - pos;
-    const auto  normal    = glm::normalize(glm::cross(tangent, bitangent));
+    // Central differences span 2 samples, the apron covers the borders so
+    // neighbouring chunks agree on their shared edge.
+    const float span = 2.0f * chunk.spacing;
 
-    const auto grassColor    = glm::vec3(0.0f, 0.2f, 0.0f);
-    const auto roadColor     = glm::vec3(0.1f, 0.1f, 0.1f);
-    const auto roadSideColor = glm::vec3(0.2f, 0.10f, 0.075f);
+    const unsigned int right = center + apronPerSide;
+    const unsigned int left  = center - apronPerSide;
+    const float        dx    = heights[right] - heights[left];
+    const float        dy    = heights[center + 1] - heights[center - 1];
 
-    const auto road = RoadNoise(noisePos);
+    return glm::vec3(-dx, -dy, span);
+}
 
-    auto color = grassColor;
-    if (road > ROAD_NOISE_THRESHOLD)
+TerrainMaterial Terrain::RoadMaterial(float roadNoise)
+{
+    if (roadNoise > ROAD_NOISE_THRESHOLD)
     {
-        color = roadColor;
+        return TerrainMaterial::ROAD;
     }
-    else if (road > 0)
+    if (roadNoise > 0)
     {
-        color = roadSideColor;
+        return TerrainMaterial::ROAD_SIDE;
     }
+    return TerrainMaterial::GRASS;
+}
 
-    return Vertex_P_N_C {
-        {worldPos.x, worldPos.y, vertexHeight},
-        normal,
-        color
+void Terrain::GenerateSkirts(Chunk& chunk, std::span<Vertex_Terrain> vertices)
+{
+    const unsigned int verticesPerSide = chunk.quadsPerSide + 1;
+    const unsigned int last            = chunk.quadsPerSide;
+
+    // Edge order matches Renderer::GenerateGridIndices.
+    const auto edgeVertex = [&](unsigned int edge, unsigned int i) -> unsigned int {
+        switch (edge)
+        {
+            case 0:
+                return i;
+            case 1:
+                return last * verticesPerSide + i;
+            case 2:
+                return i * verticesPerSide;
+            default:
+                return i * verticesPerSide + last;
+        }
     };
+
+    // A neighbour one or two levels coarser shares every 2nd or 4th edge vertex
+    // and interpolates between them, the skirt has to reach below that gap.
+    // Finer neighbours deviate from this edge by less.
+    float gap = 0.0f;
+    for (unsigned int edge = 0; edge < 4; edge++)
+    {
+        for (unsigned int stride = 2; stride <= 4; stride *= 2)
+        {
+            for (unsigned int i = 0; i + stride < verticesPerSide; i += stride)
+            {
+                const float h0 = chunk.heights[edgeVertex(edge, i)];
+                const float h1 = chunk.heights[edgeVertex(edge, i + stride)];
+
+                for (unsigned int j = 1; j < stride; j++)
+                {
+                    const float t = static_cast<float>(j) / static_cast<float>(stride);
+                    const float h = chunk.heights[edgeVertex(edge, i + j)];
+
+                    gap = std::max(gap, std::abs(h - std::lerp(h0, h1, t)));
+                }
+            }
+        }
+    }
+    chunk.skirtDepth = gap + chunk.spacing;
+
+    // Skirt vertices copy the edge, Terrain.vert moves them down.
+    const unsigned int firstSkirt = verticesPerSide * verticesPerSide;
+    for (unsigned int edge = 0; edge < 4; edge++)
+    {
+        for (unsigned int i = 0; i < verticesPerSide; i++)
+        {
+            vertices[firstSkirt + edge * verticesPerSide + i] = vertices[edgeVertex(edge, i)];
+        }
+    }
 }
 
-float Terrain::TerrainHeight(glm::vec2 pos)
+void Terrain::TerrainHeights(
+    const float* x,
+    const float* y,
+    size_t       count,
+    float*       heights,
+    float*       road
+) const
 {
-    const float terrain = TerrainNoise(pos, 6);
+    // Road terrain is the first octaves of the full terrain noise,
+    // road holds it until replaced by the road noise.
+    m_noise.Octave2D_01({
+        .x              = x,
+        .y              = y,
+        .count          = count,
+        .octaves        = TERRAIN_OCTAVES,
+        .out            = heights,
+        .partialOctaves = TERRAIN_ROAD_OCTAVES,
+        .partialOut     = road,
+    });
 
-    const float roadNoise   = RoadNoise(pos);
-    const float roadTerrain = TerrainNoise(pos, 3);
+    for (size_t i = 0; i < count; i++)
+    {
+        const float roadTerrain = road[i];
+
+        road[i]    = RoadNoise(glm::vec2(x[i], y[i]));
+        heights[i] = TerrainHeight(heights[i], roadTerrain, road[i]);
+    }
+}
 
+float Terrain::TerrainHeight(float terrain, float roadTerrain, float roadNoise) const
+{
     const float smoothTerrain = std::lerp(terrain, roadTerrain, roadNoise);
 
     float roadHeight = 0.0f;
@@ -258,12 +1701,7 @@ float Terrain::TerrainHeight(glm::vec2 pos)
     return smoothTerrain * TERRAIN_HEIGHT + roadHeight;
 }
 
-float Terrain::TerrainNoise(glm::vec2 pos, int octaves)
-{
-    return m_perlin.octave2D_01(pos.x, pos.y, octaves);
-}
-
-float Terrain::RoadNoise(glm::vec2 pos)
+float Terrain::RoadNoise(glm::vec2 pos) const
 {
     const auto roadX          = sin(pos.y * 0.5f) * 1.0f + cos(pos.y * 1.3f) * 0.3f;
     const auto roadHalfWidth  = 2.5f;
@@ -1,28 +1,191 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <span>
+#include <utility>
+#include <vector>
 
 #include <glm/vec3.hpp>
 #include <PerlinNoise.hpp>
 
+#include "../Components/Camera.h"
+#include "../Components/Frustum.h"
+#include "../Jobs/JobSystem.h"
+#include "../Renderer/RenderQueue.h"
 #include "../Renderer/Renderer.h"
 #include "Chunk.h"
+#include "ChunkCache.h"
+#include "ChunkGrid.h"
+#include "ChunkLru.h"
+#include "ChunkPool.h"
+#include "NoiseKernel.h"
 
-#define TERRAIN_DISTANCE         4
-#define CHUNK_ARR_SIZE           (2 * TERRAIN_DISTANCE + 1)
+#define TERRAIN_DISTANCE         4 // Default ChunkGrid radius
 #define TERRAIN_CHUNK_RESOLUTION 2
+#define CHUNK_QUADS_PER_SIDE     (CHUNK_SIZE * TERRAIN_CHUNK_RESOLUTION)
+#define CHUNK_VERTICES_PER_SIDE  (CHUNK_QUADS_PER_SIDE + 1)
+#define CHUNK_APRON_PER_SIDE     (CHUNK_VERTICES_PER_SIDE + 2)
 #define TERRAIN_NOISE_SCALE      0.0025f
 #define TERRAIN_HEIGHT           100
 #define ROAD_NOISE_THRESHOLD     0.9f
 #define ROAD_HEIGHT              0.25f
+#define TERRAIN_HEIGHT_RANGE     (TERRAIN_HEIGHT + ROAD_HEIGHT)
+
+// Default ChunkLru budget for chunks that left the loaded area.
+#define TERRAIN_EVICTED_BUDGET_MB 64
+
+// TerrainMode::GRID prefetching ahead of the observer's motion.
+#define TERRAIN_PREFETCH_SECONDS     2.0f  // Default lookahead
+#define TERRAIN_PREFETCH_MAX_PENDING 32    // Prefetch jobs in flight
+#define TERRAIN_VELOCITY_SMOOTHING   0.25f // Weight of the latest velocity sample
+
+// Default TerrainScheduling::TIME_SLICED budget per tick.
+#define TERRAIN_TICK_BUDGET_MS 4.0f
+
+// Initial ChunkPool size in TerrainMode::LOD, on top of the evicted budget.
+#define TERRAIN_POOL_LOD_NODES 128
+
+// Bump when generated chunks change, older ChunkCache files are then ignored.
+#define TERRAIN_GENERATOR_VERSION 2
+
+// fBm octaves of the terrain, road terrain uses a prefix of them.
+#define TERRAIN_OCTAVES      6
+#define TERRAIN_ROAD_OCTAVES 3
+
+// Multi-resolution heightfields, the first octaves are interpolated from a coarse lattice.
+#define TERRAIN_COARSE_OCTAVES   4     // Default split point
+#define TERRAIN_COARSE_MAX_ERROR 0.05f // Default interpolation error bound, in world units
+#define TERRAIN_NOISE_CURVATURE  16.0f // Bound of |d2n/dx2| + |d2n/dy2| of one Perlin octave
+#define TERRAIN_BENCHMARK_CHUNKS 64
+
+// TerrainMode::LOD quadtree. Level 0 nodes match the grid chunk resolution,
+// the root level covers TERRAIN_LOD_NODE_SIZE << (TERRAIN_LOD_LEVELS - 1).
+#define TERRAIN_LOD_LEVELS         8
+#define TERRAIN_LOD_QUADS_PER_SIDE 64
+#define TERRAIN_LOD_NODE_SIZE      (TERRAIN_LOD_QUADS_PER_SIDE / TERRAIN_CHUNK_RESOLUTION)
+#define TERRAIN_LOD_SPLIT_DISTANCE 1.25f // Split nodes closer than this many node sizes
+
+// TerrainGenerator::GPU
+#define TERRAIN_MAX_SLOPE            4.0f  // Bounds skirt depth without CPU heights
+#define TERRAIN_GPU_HEIGHT_TOLERANCE 0.05f // Max height difference to the CPU, in world units
+#define TERRAIN_GPU_NORMAL_TOLERANCE 0.01f // Max octahedral normal difference to the CPU
 
 namespace drive
 {
+// Vertex_Terrain::material, colors are in Terrain.vert.
+enum TerrainMaterial : uint16_t
+{
+    GRASS,
+    ROAD,
+    ROAD_SIDE,
+};
+
+enum class TerrainMode
+{
+    // Fixed grid of full resolution chunks around the observer.
+    GRID,
+    // Quadtree of nodes that get coarser with distance, seams are hidden by skirts.
+    LOD,
+};
+
+enum class TerrainGenerator
+{
+    // Noise kernels on the job system.
+    CPU,
+    // Compute shader writing into the vertex buffer on the render thread,
+    // chunks then have no CPU-side heights.
+    GPU,
+};
+
+enum class TerrainScheduling
+{
+    // Chunks are generated by jobs on the worker threads.
+    JOBS,
+    // Chunks are generated a heightfield row at a time on the tick thread,
+    // within a time budget per tick.
+    TIME_SLICED,
+};
+
+struct TerrainSettings
+{
+    TerrainMode      mode      = TerrainMode::GRID;
+    TerrainGenerator generator = TerrainGenerator::CPU;
+
+    // TerrainMode::GRID chunks loaded in each direction from the observer.
+    int gridRadius = TERRAIN_DISTANCE;
+
+    // Keep CPU generated chunks in a ChunkCache.
+    bool diskCache = true;
+
+    // Memory kept for evicted chunks, 0 to disable.
+    size_t evictedBudgetMB = TERRAIN_EVICTED_BUDGET_MB;
+
+    // How far ahead of the observer's velocity chunks are prefetched, 0 to disable.
+    float prefetchSeconds = TERRAIN_PREFETCH_SECONDS;
+
+    TerrainScheduling scheduling   = TerrainScheduling::JOBS;
+    float             tickBudgetMs = TERRAIN_TICK_BUDGET_MS;
+
+    // TerrainGenerator::CPU octaves evaluated on a coarse lattice and interpolated,
+    // 0 evaluates every octave per vertex. The lattice is as coarse as
+    // coarseMaxError (world units) allows.
+    int   coarseOctaves  = TERRAIN_COARSE_OCTAVES;
+    float coarseMaxError = TERRAIN_COARSE_MAX_ERROR;
+
+    // Log full and multi-resolution heightfield timings on startup.
+    bool benchmark = false;
+};
+
+// Snapshot for the debug UI.
+struct TerrainStats
+{
+    uint32_t evictedHits;
+    uint32_t evictedMisses;
+    size_t   evictedChunks;
+    size_t   evictedBytes;
+
+    // Chunks entering the grid that were already prefetched, or not (in time).
+    uint32_t prefetchHits;
+    uint32_t prefetchMisses;
+    size_t   prefetchStaged;
+
+    // TerrainScheduling::TIME_SLICED
+    size_t   slicedQueued;
+    float    slicedTickMs;   // Spent generating on the last tick
+    uint32_t slicedOverruns; // Ticks that went over the budget
+
+    // Last frame, chunks outside the view frustum are culled. Queued chunks
+    // are culled on the GPU instead, see Renderer::DrawTerrain.
+    uint32_t renderedChunks;
+    uint32_t culledChunks;
+    uint32_t queuedChunks; // Handed to GPU culling, visible or not
+
+    // ChunkPool arena, CPU memory retained including free chunks and storage.
+    size_t   poolChunks;
+    size_t   poolFree;
+    size_t   poolBytes;
+    uint32_t poolGrowths;
+
+    // Shared terrain vertex buffer, 0 slots if chunks have buffers of their own.
+    uint32_t vertexSlots;
+    uint32_t vertexSlotsFree;
+};
+
 class Terrain
 {
   public:
     Terrain() = delete;
-    Terrain(std::shared_ptr<Renderer> renderer);
+    Terrain(
+        std::shared_ptr<Renderer>  renderer,
+        std::shared_ptr<JobSystem> jobSystem,
+        TerrainSettings            settings
+    );
     ~Terrain();
 
     Terrain(const Terrain&)            = delete;
@@ -32,46 +195,234 @@ class Terrain
 
     void SetObserverPosition(glm::vec3 pos);
 
-    void Render();
+    // Chunks in the slot buffer are culled on the GPU and drawn right away, before
+    // the queue, in whatever order TerrainCull.comp's atomic append produces, not
+    // front to back. The rest are added to queue, which sorts them.
+    void Render(const Camera& camera, RenderQueue& queue);
+
+    // Furthest distance from the observer terrain can be loaded at.
+    float GetViewDistance() const;
+
+    // Safe to call from any thread.
+    TerrainStats GetStats() const;
+
+    // Ground height and optionally normal at world positions, safe to call from any thread.
+    // Loaded chunks are interpolated, elsewhere the noise is evaluated.
+    void QueryGround(
+        std::span<const glm::vec2> positions,
+        std::span<float>           heights,
+        std::span<glm::vec3>       normals = {}
+    ) const;
 
   private:
-    void MoveChunks(glm::ivec2 delta);
+    // Makes sure the chunk's vertices are on the GPU.
+    void PrepareChunk(Chunk& chunk);
+    // For culling and drawing on the GPU, false if the chunk has to be drawn directly.
+    bool QueueChunk(Chunk& chunk);
+    void RenderChunk(
+        const std::shared_ptr<Chunk>&  chunk,
+        const std::shared_ptr<Buffer>& indexBuffer,
+        const glm::vec3&               eye,
+        RenderQueue&                   queue
+    );
+    bool IsChunkVisible(const Chunk& chunk, const Frustum& frustum) const;
+
+    static std::pair<glm::vec3, glm::vec3> ChunkBounds(const Chunk& chunk);
+
     void LoadChunks();
-    void GenerateChunk(std::shared_ptr<Chunk> chunk);
+    void ScheduleChunk(ChunkKey key);
+    void PublishChunks();
+    // Snapshot of the grid for the render thread, see m_gridChunks.
+    void PublishGridChunks();
+    void PlaceChunk(std::shared_ptr<Chunk> chunk);
+    void EvictChunk(std::shared_ptr<Chunk> chunk);
+    void AddHeightfield(const std::shared_ptr<Chunk>& chunk);
+    void RemoveHeightfield(const Chunk& chunk);
+    void CreateChunkPool();
+    void CreateVertexSlots();
+    void GenerateChunkAsync(ChunkKey key);
+    void GenerateSlicedChunks();
+    // Returns the CPU-side vertices, in scratch if the chunk's are mapped.
+    std::span<const Vertex_Terrain> GenerateChunk(
+        std::shared_ptr<Chunk> chunk,
+        ChunkScratch&          scratch
+    );
+
+    // Grid vertices, plus skirts in LOD mode.
+    uint32_t ChunkVertexCount(const Chunk& chunk) const;
+    void     AllocateVertices(Chunk& chunk);
+    void     UploadVertices(Chunk& chunk);
+
+    // TerrainMode::GRID prefetching
+    bool PrefetchEnabled() const;
+    void UpdateObserverVelocity(glm::vec3 pos);
+    void PrefetchChunks();
+    void PrefetchChunk(ChunkKey key);
+
+    // TerrainMode::LOD
+    void SelectLodNodes(glm::vec3 pos);
+    void SelectLodNode(
+        glm::vec3                            pos,
+        ChunkKey                             key,
+        std::vector<std::shared_ptr<Chunk>>& selection,
+        std::set<ChunkKey>&                  keep
+    );
+    static float LodNodeSize(int lod);
+
+    // TerrainGenerator::GPU
+    TerrainGenPushConstants GpuGenParams(const Chunk& chunk) const;
+    bool                    ValidateGpuGenerator();
+
+    // Multi-resolution heightfields
+    float        CoarseSpacing() const;
+    unsigned int CoarseStride(const Chunk& chunk) const;
+    uint32_t     GeneratorVersion() const;
+    void         BenchmarkHeightfields();
+
+    // GenerateChunk stages, grids are x-major.
+    // Heights and road noise into scratch for rows [firstRow, endRow) of the vertex
+    // grid plus a one-sample apron. A coarseStride above 1 interpolates the coarse
+    // octaves from a lattice every coarseStride samples.
+    void GenerateHeightfield(
+        const Chunk&  chunk,
+        ChunkScratch& scratch,
+        unsigned int  firstRow,
+        unsigned int  endRow,
+        unsigned int  coarseStride
+    );
+    void GenerateMultiresHeightfield(
+        const Chunk&  chunk,
+        ChunkScratch& scratch,
+        unsigned int  firstRow,
+        unsigned int  endRow,
+        unsigned int  coarseStride
+    );
+    // Heights, normals, materials and skirts from the complete heightfield in scratch.
+    // Mapped vertices are built in scratch and copied over in one go, never read back.
+    // Returns the CPU-side vertices.
+    std::span<const Vertex_Terrain> GenerateVertices(
+        std::shared_ptr<Chunk> chunk,
+        ChunkScratch&          scratch
+    );
+    // center indexes the apron grid.
+    static glm::vec3 HeightfieldNormal(
+        const Chunk&              chunk,
+        const std::vector<float>& heights,
+        unsigned int              center
+    );
+    static TerrainMaterial RoadMaterial(float roadNoise);
+    // Fills the skirt vertex below each edge vertex of the CPU-side vertices.
+    void GenerateSkirts(Chunk& chunk, std::span<Vertex_Terrain> vertices);
+
+    // Heights and road noise for a batch of noise-space positions.
+    void TerrainHeights(
+        const float* x,
+        const float* y,
+        size_t       count,
+        float*       heights,
+        float*       road
+    ) const;
+    float TerrainHeight(float terrain, float roadTerrain, float roadNoise) const;
+    float RoadNoise(glm::vec2 pos) const;
+
+    // QueryGround stages.
+    void SampleHeightfield(const Chunk& chunk, glm::vec2 pos, float& height, glm::vec3* normal)
+        const;
+    void GenerateGround(
+        std::span<const glm::vec2> positions,
+        const std::vector<size_t>& indices,
+        std::span<float>           heights,
+        std::span<glm::vec3>       normals
+    ) const;
+
+    TerrainSettings m_settings;
+
+    // Multi-resolution lattice spacing in world units, 0 if disabled.
+    float m_coarseSpacing;
 
-    Vertex_P_N_C GenerateTerrain(glm::vec2 worldPos);
-    float        TerrainHeight(glm::vec2 pos);
-    float        TerrainNoise(glm::vec2 pos, int octaves);
-    float        RoadNoise(glm::vec2 pos);
+    // TerrainMode::GRID, centered on the observer's chunk.
+    // Tick thread only, apart from the fixed radius.
+    ChunkGrid m_grid;
 
-    // Returns a loaded chunk at position (chunk-space).
-    // nullptr if position is not loaded.
-    std::shared_ptr<Chunk> GetChunkAt(glm::ivec2 position)
+    // TerrainMode::LOD, generated nodes on the selected paths of the quadtree.
+    std::map<ChunkKey, std::shared_ptr<Chunk>> m_lodNodes;
+
+    // Nodes to render, swapped in by the tick thread.
+    std::mutex                          m_lodSelectionMutex;
+    std::vector<std::shared_ptr<Chunk>> m_lodSelection;
+
+    // Loaded grid chunks to render, swapped in by the tick thread whenever m_grid
+    // changed. The render thread never reads m_grid itself.
+    std::mutex                          m_gridChunksMutex;
+    std::vector<std::shared_ptr<Chunk>> m_gridChunks;
+    bool                                m_gridChanged = false;
+
+    // Smoothed observer motion, world units per second.
+    glm::vec2 m_observerWorldPosition;
+    glm::vec2 m_observerVelocity;
+    double    m_observerTime;
+
+    // Prefetched chunks outside the grid, placed when they enter it.
+    std::map<ChunkKey, std::shared_ptr<Chunk>> m_prefetchedChunks;
+    // Pending chunks that are staged instead of placed once generated.
+    std::set<ChunkKey> m_prefetchingChunks;
+
+    std::atomic<uint32_t> m_prefetchHits {0};
+    std::atomic<uint32_t> m_prefetchMisses {0};
+    std::atomic<size_t>   m_prefetchStaged {0};
+
+    std::shared_ptr<Renderer>  m_renderer;
+    std::shared_ptr<JobSystem> m_jobSystem;
+
+    // Full resolution chunks with CPU heights by chunk position, for QueryGround.
+    mutable std::shared_mutex                             m_heightfieldsMutex;
+    std::map<std::pair<int, int>, std::shared_ptr<Chunk>> m_heightfields;
+    float                                                 m_heightfieldSize;
+
+    // Evicted chunks, reused before generating them again.
+    ChunkLru m_evictedChunks;
+
+    // Chunks scheduled for generation.
+    std::set<ChunkKey> m_pendingChunks;
+    JobCounter         m_pendingJobs;
+
+    // TerrainScheduling::TIME_SLICED, chunks with part of their heightfield generated.
+    struct SlicedChunk
     {
-        auto x = position.x % CHUNK_ARR_SIZE;
-        auto y = position.y % CHUNK_ARR_SIZE;
-        if (x < 0)
-        {
-            x += CHUNK_ARR_SIZE;
-        }
-        if (y < 0)
-        {
-            y += CHUNK_ARR_SIZE;
-        }
-        if (m_loadedChunks[x][y]->position == position)
-        {
-            return m_loadedChunks[x][y];
-        }
-        return nullptr;
-    }
-
-    std::shared_ptr<Chunk> m_loadedChunks[CHUNK_ARR_SIZE][CHUNK_ARR_SIZE];
-
-    glm::ivec2 m_observerPosition;
-
-    std::shared_ptr<Renderer> m_renderer;
+        std::shared_ptr<Chunk>        chunk;
+        std::unique_ptr<ChunkScratch> scratch;
+        unsigned int                  nextRow;
+    };
+    std::deque<SlicedChunk> m_slicedChunks;
+
+    // Smoothed cost of one heightfield row, rows past the first of a tick only start if
+    // they fit the budget.
+    double m_slicedRowTime;
+
+    std::atomic<size_t>   m_slicedQueued {0};
+    std::atomic<float>    m_slicedTickMs {0.0f};
+    std::atomic<uint32_t> m_slicedOverruns {0};
+
+    std::atomic<uint32_t> m_renderedChunks {0};
+    std::atomic<uint32_t> m_culledChunks {0};
+    std::atomic<uint32_t> m_queuedChunks {0};
+
+    // Generated chunks waiting to be placed in m_grid or m_lodNodes.
+    std::mutex                          m_generatedMutex;
+    std::vector<std::shared_ptr<Chunk>> m_generatedChunks;
+
+    // Generated chunks from previous runs, nullptr if disabled.
+    std::unique_ptr<ChunkCache> m_chunkCache;
+
+    // Every chunk and its generation storage, recycled once unreferenced.
+    std::unique_ptr<ChunkPool> m_chunkPool;
+
+    // Vertex buffer for every chunk sized like the pool's, drawn with a single bind.
+    // nullptr with GPU generation or if the renderer has no slot buffers.
+    std::shared_ptr<BufferSlots> m_vertexSlots;
 
     siv::PerlinNoise::seed_type  m_perlinSeed;
     siv::BasicPerlinNoise<float> m_perlin;
+    NoiseKernel                  m_noise;
 };
 }; // namespace drive
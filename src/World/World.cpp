@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "World.h"
 #include "../Log.h"
 #include "src/Renderer/Renderer.h"
@@ -5,11 +7,17 @@
 namespace drive
 {
 
-World::World(std::shared_ptr<Renderer> renderer) : m_renderer(renderer)
+World::World(
+    std::shared_ptr<Renderer>  renderer,
+    std::shared_ptr<JobSystem> jobSystem,
+    TerrainSettings            terrainSettings
+) :
+    m_renderer(renderer)
 {
     LOG_DEBUG("Creating World");
-    m_terrain = std::make_unique<Terrain>(renderer);
-    m_sky     = std::make_unique<Sky>(renderer);
+    m_terrain      = std::make_unique<Terrain>(renderer, jobSystem, terrainSettings);
+    m_viewDistance = std::max(CAM_FAR, m_terrain->GetViewDistance());
+    m_sky          = std::make_unique<Sky>(renderer, m_viewDistance);
 
     // Test icosphere
     auto                      testSphere = Icosphere(glm::vec3(0, 0, 106), 5.0f, 2);
@@ -65,6 +73,25 @@ World::~World()
     LOG_DEBUG("Destroying World");
 }
 
+float World::GetViewDistance() const
+{
+    return m_viewDistance;
+}
+
+TerrainStats World::GetTerrainStats() const
+{
+    return m_terrain->GetStats();
+}
+
+void World::QueryGround(
+    std::span<const glm::vec2> positions,
+    std::span<float>           heights,
+    std::span<glm::vec3>       normals
+) const
+{
+    m_terrain->QueryGround(positions, heights, normals);
+}
+
 void World::Frame()
 {
 }
@@ -77,16 +104,23 @@ void World::Tick(std::shared_ptr<Camera> camera)
     }
 }
 
-void World::Render()
+void World::Render(std::shared_ptr<Camera> camera)
 {
-    m_terrain->Render();
+    m_terrain->Render(*camera, m_renderQueue);
 
-    m_renderer->BindPipeline(RenderPipeline::TERRAIN);
-    m_renderer->DrawWithBuffers(m_testSphereVertexBuffer, m_testSphereIndexBuffer);
+    m_renderQueue.Add({
+        .pipeline     = RenderPipeline::LIT,
+        .vertexBuffer = m_testSphereVertexBuffer,
+        .indexBuffer  = m_testSphereIndexBuffer,
+    });
+    m_renderQueue.Add({
+        .pipeline     = RenderPipeline::TEST,
+        .vertexBuffer = m_testPlaneVertexBuffer,
+        .indexBuffer  = m_testPlaneIndexBuffer,
+    });
 
-    m_renderer->BindPipeline(RenderPipeline::TEST);
-    m_renderer->DrawWithBuffers(m_testPlaneVertexBuffer, m_testPlaneIndexBuffer);
+    m_sky->Render(m_renderQueue);
 
-    m_sky->Render();
+    m_renderQueue.Draw(*m_renderer);
 }
 } // namespace drive
@@ -2,7 +2,10 @@
 
 #include <memory>
 #include <mutex>
+#include <span>
 
+#include "../Jobs/JobSystem.h"
+#include "../Renderer/RenderQueue.h"
 #include "Icosphere.h"
 #include "Sky.h"
 #include "Terrain.h"
@@ -13,7 +16,11 @@ class World
 {
   public:
     World() = delete;
-    World(std::shared_ptr<Renderer> renderer);
+    World(
+        std::shared_ptr<Renderer>  renderer,
+        std::shared_ptr<JobSystem> jobSystem,
+        TerrainSettings            terrainSettings
+    );
     ~World();
 
     World(const World&)            = delete;
@@ -23,16 +30,33 @@ class World
 
     void Frame();
     void Tick(std::shared_ptr<Camera> camera);
-    void Render();
+    void Render(std::shared_ptr<Camera> camera);
+
+    // Camera far plane needed to see all loaded terrain.
+    float GetViewDistance() const;
+
+    TerrainStats GetTerrainStats() const;
+
+    // See Terrain::QueryGround.
+    void QueryGround(
+        std::span<const glm::vec2> positions,
+        std::span<float>           heights,
+        std::span<glm::vec3>       normals = {}
+    ) const;
 
   private:
     std::mutex m_worldMutex;
 
+    float m_viewDistance;
+
     std::shared_ptr<Renderer> m_renderer;
 
     std::unique_ptr<Terrain> m_terrain;
     std::unique_ptr<Sky>     m_sky;
 
+    // Filled and drawn by Render.
+    RenderQueue m_renderQueue;
+
     std::shared_ptr<Buffer> m_testSphereVertexBuffer;
     std::shared_ptr<Buffer> m_testSphereIndexBuffer;
 
@@ -1,9 +1,23 @@
 #include "Engine.h"
 #include "Log.h"
 
+#include <cstdlib>
 #include <cstring>
 #include <exception>
 
+// Value following name, nullptr if not given.
+const char* GetLaunchArg(const char* name, int argc, char** argv)
+{
+    for (int i = 0; i < argc - 1; i++)
+    {
+        if (std::strcmp(name, argv[i]) == 0)
+        {
+            return argv[i + 1];
+        }
+    }
+    return nullptr;
+}
+
 bool HasLaunchArg(const char* name, const char* value, int argc, char** argv)
 {
     for (int i = 0; i < argc; i++)
@@ -38,7 +52,52 @@ int main(int argc, char** argv)
         {
             rendererType = drive::RendererType::EMPTY;
         }
-        drive::Engine engine(rendererType);
+        drive::TerrainSettings terrainSettings;
+        if (HasLaunchArg("-terrain", "lod", argc, argv))
+        {
+            terrainSettings.mode = drive::TerrainMode::LOD;
+        }
+        if (HasLaunchArg("-terrain-gen", "gpu", argc, argv))
+        {
+            terrainSettings.generator = drive::TerrainGenerator::GPU;
+        }
+        if (const char* distance = GetLaunchArg("-terrain-distance", argc, argv))
+        {
+            terrainSettings.gridRadius = std::atoi(distance);
+        }
+        if (HasLaunchArg("-terrain-cache", "off", argc, argv))
+        {
+            terrainSettings.diskCache = false;
+        }
+        if (const char* budget = GetLaunchArg("-terrain-evicted-mb", argc, argv))
+        {
+            terrainSettings.evictedBudgetMB = std::strtoull(budget, nullptr, 10);
+        }
+        if (HasLaunchArg("-terrain-prefetch", "off", argc, argv))
+        {
+            terrainSettings.prefetchSeconds = 0.0f;
+        }
+        if (HasLaunchArg("-terrain-schedule", "sliced", argc, argv))
+        {
+            terrainSettings.scheduling = drive::TerrainScheduling::TIME_SLICED;
+        }
+        if (const char* budget = GetLaunchArg("-terrain-tick-budget-ms", argc, argv))
+        {
+            terrainSettings.tickBudgetMs = std::strtof(budget, nullptr);
+        }
+        if (const char* octaves = GetLaunchArg("-terrain-coarse-octaves", argc, argv))
+        {
+            terrainSettings.coarseOctaves = std::atoi(octaves);
+        }
+        if (const char* error = GetLaunchArg("-terrain-coarse-error", argc, argv))
+        {
+            terrainSettings.coarseMaxError = std::strtof(error, nullptr);
+        }
+        if (HasLaunchArg("-terrain-bench", "on", argc, argv))
+        {
+            terrainSettings.benchmark = true;
+        }
+        drive::Engine engine(rendererType, terrainSettings);
     }
     catch (std::exception& ex)
     {